@@ -0,0 +1,115 @@
+/**
+ * @file bench.hpp
+ * @author Yufei Li, Jingxuan Liu
+ * @brief Shared helpers and workloads for benchmarks.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../include/template.hpp"
+
+/**
+ * @brief Run a function repeatedly and measure the average time of one run.
+ * @param runs Number of runs.
+ * @param f The function to be measured.
+ * @return Average time of one run in microseconds.
+ */
+template <typename F>
+double time_per_run(int runs, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; ++i)
+        f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / runs;
+}
+
+/**
+ * @brief Print one benchmark result as "name value unit". Lower values are better,
+ * which is what `make bench-compare` relies on.
+ */
+inline void report(const char* name, double value, const char* unit)
+{
+    std::printf("%-40s %14.3f %s\n", name, value, unit);
+    std::fflush(stdout);
+}
+
+/**
+ * @brief Get an integer argument of a benchmark, or the default value if absent.
+ */
+inline int int_arg(int argc, char* argv[], int index, int default_value)
+{
+    return argc > index ? std::atoi(argv[index]) : default_value;
+}
+
+/**
+ * @brief A deterministic scripted AI touching most parts of the game logic: it builds,
+ * upgrades and downgrades towers, upgrades its base and uses all super weapons.
+ * Used as the fixed self-play workload of benchmarks and profile-guided builds.
+ */
+inline std::vector<Operation> scripted_ai(int player_id, const GameInfo& info)
+{
+    Random random((info.round + 1) * 2 + player_id);
+    auto next = [&random] { return static_cast<int>(random.get() >> 17); }; // Drop weak low bits
+    std::vector<Operation> ops;
+    // Build on a pseudo-random highland
+    int x = next() % MAP_SIZE, y = next() % MAP_SIZE;
+    if (is_highland(player_id, x, y))
+        ops.emplace_back(BuildTower, x, y);
+    // Upgrade or downgrade one of own towers
+    for (const Tower& tower: info.towers)
+    {
+        if (tower.player != player_id || next() % 4)
+            continue;
+        if (tower.type == TowerType::Basic) // Level 1 -> level 2
+            ops.emplace_back(UpgradeTower, tower.id, 1 + next() % 3);
+        else if (tower.type < 10) // Level 2 -> level 3
+            ops.emplace_back(UpgradeTower, tower.id, tower.type * 10 + 1 + next() % 3);
+        else if (next() % 8 == 0)
+            ops.emplace_back(DowngradeTower, tower.id);
+        break;
+    }
+    // Use a super weapon around an ant
+    if (!info.ants.empty() && next() % 16 == 0)
+    {
+        const Ant& ant = info.ants[next() % info.ants.size()];
+        int type = UseLightningStorm + next() % 4;
+        ops.emplace_back(static_cast<OperationType>(type), ant.x, ant.y);
+    }
+    // Upgrade base when rich
+    if (info.coins[player_id] > 300)
+        ops.emplace_back(next() % 2 ? UpgradeGenerationSpeed : UpgradeGeneratedAnt);
+    return ops;
+}
+
+/**
+ * @brief Play a self-play game of scripted_ai() and get the state at a given round, as a
+ * typical root of search.
+ * @param seed Seed of the game.
+ * @param round Round to stop at.
+ * @return Game state before both players act in the given round.
+ */
+inline GameInfo scripted_state(unsigned long long seed, int round)
+{
+    Simulator s(GameInfo{seed});
+    while (s.get_info().round < round)
+    {
+        for (int player = 0; player < 2; ++player)
+        {
+            for (auto& op: scripted_ai(player, s.get_info()))
+                s.add_operation_of_player(player, op);
+            s.apply_operations_of_player(player);
+        }
+        if (s.next_round() != GameState::Running)
+            break;
+    }
+    return s.get_info();
+}
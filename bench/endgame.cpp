@@ -0,0 +1,49 @@
+#include <cstdio>
+#include "bench.hpp"
+#include "../include/endgame.hpp"
+
+// Endgame solver on synthetic endgames: positions a few rounds before MAX_ROUND, and mid-game
+// positions where one base is left with little hp. Reports time and nodes per solve, and how many
+// positions are resolved within candidate moves on stderr.
+// Usage: endgame [positions] [rounds]
+int main(int argc, char* argv[])
+{
+    int positions = int_arg(argc, argv, 1, 8);
+    int rounds = int_arg(argc, argv, 2, 3);
+
+    std::vector<GameInfo> endgames;
+    for (int i = 0; i < positions; ++i)
+    {
+        // Near the round limit
+        endgames.push_back(scripted_state(i + 1, MAX_ROUND - rounds + 1));
+        // A base about to fall
+        GameInfo info = scripted_state(i + 101, 120 + 10 * i);
+        info.bases[i % 2].hp = 1 + i % 3;
+        endgames.push_back(info);
+    }
+
+    EndgameSolver::Options options;
+    options.max_nodes = 100000;
+    long long nodes = 0;
+    int resolved = 0, index = 0;
+    double solve_time = time_per_run(endgames.size(), [&] {
+        EndgameSolver solver(options);
+        EndgameResult result = solver.solve(endgames[index++], 0, rounds);
+        nodes += result.nodes;
+        resolved += result.outcome != EndgameOutcome::Unresolved;
+    });
+    report("endgame.solve", solve_time, "us/solve");
+    report("endgame.nodes", static_cast<double>(nodes) / endgames.size(), "nodes/solve");
+
+    // The hash alone, computed once per node
+    GameInfo root = scripted_state(42, 200);
+    unsigned long long checksum = 0;
+    double hash_time = time_per_run(20000, [&] {
+        checksum += root.hash();
+        ++root.round;
+    });
+    report("gameinfo.hash", hash_time, "us/hash");
+
+    std::fprintf(stderr, "resolved %d/%d checksum %llu\n", resolved, static_cast<int>(endgames.size()), checksum);
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <cstdio>
+#include "bench.hpp"
+#include "../include/flow_field.hpp"
+
+// Flow fields of a scripted game: from scratch every round, kept across rounds, and kept across
+// what-if edits of one round where a single ant's trail changes. Only flow fields are timed.
+// Usage: flow_field [rounds]
+int main(int argc, char* argv[])
+{
+    int rounds = int_arg(argc, argv, 1, 300);
+
+    std::vector<GameInfo> states;
+    Simulator s(GameInfo{42});
+    for (int round = 0; round < rounds; ++round)
+    {
+        states.push_back(s.get_info());
+        for (int player = 0; player < 2; ++player)
+        {
+            for (auto& op: scripted_ai(player, s.get_info()))
+                s.add_operation_of_player(player, op);
+            s.apply_operations_of_player(player);
+        }
+        if (s.next_round() != GameState::Running)
+            break;
+    }
+
+    double checksum = 0;
+    std::size_t index = 0;
+    double scratch_time = time_per_run(states.size(), [&] {
+        FlowField flow;
+        flow.update(states[index++]);
+        checksum += flow.visits(0)[Base::POSITION[1][0] * MAP_SIZE + Base::POSITION[1][1]];
+    });
+    report("flow_field.from_scratch", scratch_time, "us/round");
+
+    // Pheromone attenuates everywhere every round, so this is about a full recompute
+    FlowField kept;
+    index = 0;
+    long long evaluations = kept.get_evaluations();
+    double rounds_time = time_per_run(states.size(), [&] {
+        kept.update(states[index++]);
+        checksum -= kept.visits(0)[Base::POSITION[1][0] * MAP_SIZE + Base::POSITION[1][1]];
+    });
+    report("flow_field.across_rounds", rounds_time, "us/round");
+    report("flow_field.across_rounds.evaluations",
+        static_cast<double>(kept.get_evaluations() - evaluations) / states.size(), "moves/round");
+
+    // What-if: the oldest alive ant of each state is killed, leaving its failure trail
+    std::vector<GameInfo> edited;
+    for (const GameInfo& info: states)
+    {
+        edited.push_back(info);
+        for (Ant ant: info.ants)
+            if (ant.is_alive())
+            {
+                ant.state = AntState::Fail;
+                edited.back().update_pheromone(ant);
+                break;
+            }
+    }
+    long long mismatches = 0;
+    int runs = 0;
+    double edit_time = 0;
+    evaluations = 0;
+    for (std::size_t i = 0; i < states.size(); ++i)
+    {
+        FlowField flow;
+        flow.update(states[i]);
+        long long before = flow.get_evaluations();
+        edit_time += time_per_run(1, [&] { flow.update(edited[i]); });
+        evaluations += flow.get_evaluations() - before;
+        ++runs;
+        FlowField fresh;
+        fresh.update(edited[i]);
+        for (int player = 0; player < 2; ++player)
+            for (int cell = 0; cell < FlowField::STRIDE; ++cell)
+                mismatches += flow.visits(player)[cell] != fresh.visits(player)[cell];
+    }
+    report("flow_field.local_edit", edit_time / runs, "us/edit");
+    report("flow_field.local_edit.evaluations", static_cast<double>(evaluations) / runs, "moves/edit");
+
+    std::fprintf(stderr, "%zu rounds, %lld mismatches, checksum %.6f\n", states.size(), mismatches, checksum);
+    return mismatches == 0 ? 0 : 1;
+}
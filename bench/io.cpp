@@ -0,0 +1,60 @@
+#include <sstream>
+#include "bench.hpp"
+
+// Benchmarks of message parsing and optional-returning queries. Build with different
+// standards (see `make bench-std`) to compare the C++11 baseline with the C++17 fast path.
+// Usage: io [runs]
+int main(int argc, char* argv[])
+{
+    int runs = int_arg(argc, argv, 1, 20000);
+    GameInfo info = scripted_state(42, 200);
+
+    // Serialize round info in the layout of judger
+    std::ostringstream round_out;
+    round_out << info.round << '\n' << info.towers.size() << '\n';
+    for (auto& tower: info.towers)
+        round_out << tower.id << ' ' << tower.player << ' ' << tower.x << ' ' << tower.y << ' '
+                  << tower.type << ' ' << tower.cd << '\n';
+    round_out << info.ants.size() << '\n';
+    for (auto& ant: info.ants)
+        round_out << ant.id << ' ' << ant.player << ' ' << ant.x << ' ' << ant.y << ' '
+                  << ant.hp << ' ' << ant.level << ' ' << ant.age << ' ' << ant.state << '\n';
+    round_out << info.coins[0] << ' ' << info.coins[1] << '\n'
+              << info.bases[0].hp << ' ' << info.bases[1].hp << '\n';
+    std::string round_text = round_out.str();
+
+    // Serialize operations in the layout of judger
+    std::vector<Operation> ops = {
+        Operation(BuildTower, 6, 1), Operation(UpgradeTower, 3, 21), Operation(DowngradeTower, 5),
+        Operation(UseEmpBlaster, 9, 9), Operation(UpgradeGeneratedAnt)
+    };
+    std::ostringstream ops_out;
+    ops_out << ops.size() << '\n';
+    for (auto& op: ops)
+        ops_out << op;
+    std::string ops_text = ops_out.str();
+
+    int checksum = 0;
+    double round_time = time_per_run(runs, [&] {
+        std::istringstream in(round_text);
+        checksum += read_round_info(in).ants.size();
+    });
+    report("read_round_info", round_time, "us/msg");
+
+    double ops_time = time_per_run(runs, [&] {
+        std::istringstream in(ops_text);
+        checksum += read_opponent_operations(in).size();
+    });
+    report("read_opponent_operations", ops_time, "us/msg");
+
+    double query_time = time_per_run(runs, [&] {
+        for (auto& tower: info.towers)
+            checksum += info.tower_of_id(tower.id).value().cd + (info.tower_at(tower.x, tower.y) ? 1 : 0);
+        for (auto& ant: info.ants)
+            checksum += info.ant_of_id(ant.id).value().hp;
+    });
+    report("optional_queries", query_time, "us/state");
+
+    std::fprintf(stderr, "checksum %d\n", checksum);
+    return 0;
+}
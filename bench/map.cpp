@@ -0,0 +1,59 @@
+#include <cstdio>
+#include "bench.hpp"
+
+// The default map as DefaultMap, which forwards to the global constants, against the same layout
+// through the generic MapDescriptor, which every other map uses. Both must play identical games
+// at the same speed.
+// Usage: map [games]
+
+struct DefaultLayout
+{
+    static constexpr int SIZE = MAP_SIZE;
+    static constexpr const int (&PROPERTY)[MAP_SIZE][MAP_SIZE] = MAP_PROPERTY;
+    static constexpr const int (&BASE_POSITION)[2][2] = Base::POSITION;
+};
+
+constexpr const int (&DefaultLayout::PROPERTY)[MAP_SIZE][MAP_SIZE];
+constexpr const int (&DefaultLayout::BASE_POSITION)[2][2];
+
+/**
+ * @brief Play a game where both players only upgrade their bases, and hash the final state.
+ */
+template <typename Map>
+unsigned long long play(unsigned long long seed)
+{
+    BasicSimulator<Map> s{BasicGameInfo<Map>(seed)};
+    while (true)
+    {
+        for (int player = 0; player < 2; ++player)
+        {
+            s.add_operation_of_player(player, Operation(UpgradeGenerationSpeed));
+            s.add_operation_of_player(player, Operation(UpgradeGeneratedAnt));
+            s.apply_operations_of_player(player);
+        }
+        if (s.next_round() != GameState::Running)
+            break;
+    }
+    return s.get_info().hash();
+}
+
+int main(int argc, char* argv[])
+{
+    int games = int_arg(argc, argv, 1, 20);
+
+    unsigned long long hashes[2] = {};
+    unsigned long long seed = 0;
+    double default_time = time_per_run(games, [&] {
+        hashes[0] ^= play<DefaultMap>(++seed);
+    });
+    report("map.default", default_time, "us/game");
+
+    seed = 0;
+    double generic_time = time_per_run(games, [&] {
+        hashes[1] ^= play<MapDescriptor<DefaultLayout>>(++seed);
+    });
+    report("map.descriptor", generic_time, "us/game");
+
+    std::fprintf(stderr, "hashes %016llx %016llx\n", hashes[0], hashes[1]);
+    return hashes[0] == hashes[1] ? 0 : 1;
+}
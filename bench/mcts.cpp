@@ -0,0 +1,41 @@
+#include <cstdio>
+#include "bench.hpp"
+#include "../include/mcts.hpp"
+
+// Self-play of MCTS for both players with the same iterations per move, throwing the tree away
+// every round against re-rooting it at the actual state. Lower time per root visit means more
+// search for the same time.
+// Usage: mcts [rounds] [iterations]
+int main(int argc, char* argv[])
+{
+    int rounds = int_arg(argc, argv, 1, 40);
+    int iterations = int_arg(argc, argv, 2, 500);
+
+    for (int reuse = 0; reuse < 2; ++reuse)
+    {
+        MctsSearch search[2];
+        Simulator s(GameInfo{42});
+        long long visits = 0, reused = 0;
+        double time = time_per_run(1, [&] {
+            for (int round = 0; round < rounds; ++round)
+            {
+                for (int player = 0; player < 2; ++player)
+                {
+                    if (!reuse)
+                        search[player].clear();
+                    MctsResult result = search[player].search(s.get_info(), player, iterations);
+                    visits += result.root_visits;
+                    reused += result.reused_visits;
+                    for (auto& op: result.operations)
+                        s.add_operation_of_player(player, op);
+                    s.apply_operations_of_player(player);
+                }
+                if (s.next_round() != GameState::Running)
+                    break;
+            }
+        });
+        report(reuse ? "mcts.reuse" : "mcts.fresh", time / visits, "us/root-visit");
+        std::fprintf(stderr, "%s: %lld root visits, %lld reused\n", reuse ? "reuse" : "fresh", visits, reused);
+    }
+    return 0;
+}
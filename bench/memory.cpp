@@ -0,0 +1,60 @@
+#define ANTWAR_COUNT_ALLOCATIONS
+#include <iostream>
+#include <string>
+#include "bench.hpp"
+#include "../include/memory.hpp"
+
+// Memory footprint of simulators, for sizing transposition tables and node pools.
+// For each N, keeps N simulators alive at once, each rolled forward from a mid-game root as in
+// a search, and reports the peak of live heap and the peak RSS of the process so far. What
+// memory_usage() accounts for all simulators must match the peak of live heap within 1% from
+// 100 simulators on, where transient allocations of a round no longer matter.
+// Usage: memory [max_simulators]
+int main(int argc, char* argv[])
+{
+    int max_simulators = int_arg(argc, argv, 1, 10000);
+    int mismatches = 0;
+    GameInfo root = scripted_state(42, 200);
+    std::cerr << "root " << Simulator(root).memory_usage();
+
+    for (int n = 1; n <= max_simulators; n *= 10)
+    {
+        AllocationStats::instance().reset_peak();
+        std::size_t base = AllocationStats::instance().current;
+        std::size_t accounted;
+        {
+            std::vector<Simulator> simulators;
+            simulators.reserve(n);
+            for (int i = 0; i < n; ++i)
+            {
+                simulators.emplace_back(root);
+                Simulator& s = simulators.back();
+                for (int round = 0; round < 10; ++round)
+                {
+                    for (int player = 0; player < 2; ++player)
+                    {
+                        for (auto& op: scripted_ai(player, s.get_info()))
+                            s.add_operation_of_player(player, op);
+                        s.apply_operations_of_player(player);
+                    }
+                    if (s.next_round() != GameState::Running)
+                        break;
+                }
+            }
+            accounted = 0;
+            for (auto& s: simulators)
+                accounted += s.memory_usage().total();
+            std::string name = "simulators." + std::to_string(n);
+            report((name + ".memory_usage").c_str(), accounted / 1024.0 / n, "KiB/sim");
+        }
+        std::string name = "simulators." + std::to_string(n);
+        double peak = AllocationStats::instance().peak - base;
+        report((name + ".peak_heap").c_str(), peak / 1024.0, "KiB");
+        report((name + ".peak_rss").c_str(), peak_rss(), "KiB");
+        std::cerr << n << " simulators: memory_usage() accounts for " << 100.0 * accounted / peak
+                  << "% of peak heap" << std::endl;
+        if (n >= 100)
+            mismatches += accounted < 0.99 * peak || accounted > 1.01 * peak;
+    }
+    return mismatches == 0 ? 0 : 1;
+}
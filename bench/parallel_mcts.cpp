@@ -0,0 +1,80 @@
+#include <cstdio>
+#include <thread>
+#include "bench.hpp"
+#include "../include/mcts.hpp"
+
+// Tree-parallel MCTS against root-parallel MCTS (independent trees whose root visits are summed)
+// at 1, 2, 4 and 8 threads, with the same total iterations per move. Strength is the share of
+// positions where the chosen move agrees with a long single-threaded search, and strength per
+// second divides it by the time per move.
+// Usage: parallel_mcts [iterations] [positions]
+int main(int argc, char* argv[])
+{
+    int iterations = int_arg(argc, argv, 1, 1000);
+    int positions = int_arg(argc, argv, 2, 8);
+
+    std::vector<GameInfo> roots;
+    std::vector<std::vector<Operation>> reference;
+    for (int i = 0; i < positions; ++i)
+    {
+        roots.push_back(scripted_state(42 + i, 30 + 25 * i));
+        MctsSearch search;
+        reference.push_back(search.search(roots.back(), 0, iterations * 8).operations);
+    }
+    auto same = [](const std::vector<Operation>& a, const std::vector<Operation>& b)
+    {
+        if (a.size() != b.size())
+            return false;
+        for (std::size_t i = 0; i < a.size(); ++i)
+            if (a[i].type != b[i].type || a[i].arg0 != b[i].arg0 || a[i].arg1 != b[i].arg1)
+                return false;
+        return true;
+    };
+
+    for (int threads: {1, 2, 4, 8})
+    {
+        int agree[2] = {};
+        // Root parallel: one MctsSearch per thread
+        double root_time = time_per_run(1, [&] {
+            for (int p = 0; p < positions; ++p)
+            {
+                std::vector<MctsResult> results(threads);
+                std::vector<std::thread> workers;
+                for (int t = 0; t < threads; ++t)
+                    workers.emplace_back([&, t] {
+                        MctsSearch search;
+                        results[t] = search.search(roots[p], 0, iterations / threads);
+                    });
+                for (auto& w: workers)
+                    w.join();
+                // Every tree lists the same moves in the same order
+                std::vector<int> visits(results[0].moves.size());
+                for (auto& result: results)
+                    for (std::size_t m = 0; m < visits.size(); ++m)
+                        visits[m] += result.moves[m].visits;
+                std::size_t best = 0;
+                for (std::size_t m = 1; m < visits.size(); ++m)
+                    if (visits[m] > visits[best])
+                        best = m;
+                agree[0] += same(results[0].moves[best].operations, reference[p]);
+            }
+        });
+        // Tree parallel: one shared tree
+        ParallelMctsSearch::Options options;
+        options.threads = threads;
+        ParallelMctsSearch search(options);
+        double tree_time = time_per_run(1, [&] {
+            for (int p = 0; p < positions; ++p)
+                agree[1] += same(search.search(roots[p], 0, iterations).operations, reference[p]);
+        });
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "parallel_mcts.root.threads%d", threads);
+        report(name, root_time / positions, "us/move");
+        std::snprintf(name, sizeof(name), "parallel_mcts.tree.threads%d", threads);
+        report(name, tree_time / positions, "us/move");
+        std::fprintf(stderr, "threads %d: root agrees %d/%d (%.2f/s), tree agrees %d/%d (%.2f/s)\n", threads,
+            agree[0], positions, agree[0] * 1e6 / root_time, agree[1], positions, agree[1] * 1e6 / tree_time);
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include <cstdio>
+#include <cstring>
+#include "bench.hpp"
+
+// End-of-round pheromone update: attenuation and per-ant updates as two calls, against the single
+// update_pheromone_for_round(). States come from a scripted game, with some ants marked as having
+// failed, succeeded or aged out so that deposits happen every round.
+// Usage: pheromone [rounds] [runs]
+int main(int argc, char* argv[])
+{
+    int rounds = int_arg(argc, argv, 1, 250);
+    int runs = int_arg(argc, argv, 2, 20);
+
+    std::vector<GameInfo> states;
+    Simulator s(GameInfo{42});
+    for (int round = 0; round < rounds; ++round)
+    {
+        GameInfo state = s.get_info();
+        for (std::size_t i = 0; i < state.ants.size(); ++i)
+            if (i % 3 == 0)
+                state.ants[i].state = static_cast<AntState>(AntState::Success + round % 3);
+        states.push_back(state);
+        for (int player = 0; player < 2; ++player)
+        {
+            for (auto& op: scripted_ai(player, s.get_info()))
+                s.add_operation_of_player(player, op);
+            s.apply_operations_of_player(player);
+        }
+        if (s.next_round() != GameState::Running)
+            break;
+    }
+
+    std::vector<GameInfo> separate(states), fused(states);
+    double separate_time = time_per_run(runs, [&] {
+        for (auto& info: separate)
+        {
+            info.global_pheromone_attenuation();
+            info.update_pheromone_for_ants();
+        }
+    });
+    report("pheromone.separate", separate_time / states.size(), "us/round");
+
+    double fused_time = time_per_run(runs, [&] {
+        for (auto& info: fused)
+            info.update_pheromone_for_round();
+    });
+    report("pheromone.for_round", fused_time / states.size(), "us/round");
+
+    long long mismatches = 0;
+    for (std::size_t i = 0; i < states.size(); ++i)
+        mismatches += std::memcmp(separate[i].pheromone, fused[i].pheromone, sizeof(separate[i].pheromone)) != 0;
+    std::fprintf(stderr, "%zu rounds, %lld mismatches\n", states.size(), mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
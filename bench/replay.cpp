@@ -0,0 +1,105 @@
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include "bench.hpp"
+#include "../include/replay.hpp"
+
+// Replay archives of scripted_ai self-play, appended from several threads, without keyframes and
+// with a keyframe every 32 rounds: bytes per game against the text dump of every round, time to
+// decode a game, and time to rebuild the state at a random round. Decoded games must equal recorded
+// ones, and rebuilt states must hash like the states of the original games.
+// Usage: replay [games] [threads]
+int main(int argc, char* argv[])
+{
+    int games = int_arg(argc, argv, 1, 200);
+    int threads = int_arg(argc, argv, 2, 4);
+
+    std::vector<ReplayGame> recorded;
+    for (int i = 0; i < games; ++i)
+        recorded.push_back(record_game(scripted_ai, scripted_ai, i + 1));
+
+    // Text dump of every round of the first game, for comparison
+    const char* dump_path = "/tmp/antwar_replay_dump.txt";
+    std::remove(dump_path);
+    {
+        Simulator s(GameInfo{recorded[0].seed});
+        for (auto& round: recorded[0].rounds)
+        {
+            s.get_info().dump(dump_path);
+            ReplayFormat::replay_round(s, round);
+        }
+    }
+    std::ifstream dumped(dump_path, std::ios::binary | std::ios::ate);
+    report("replay.dump_bytes", static_cast<double>(dumped.tellg()), "bytes/game");
+    std::remove(dump_path);
+
+    long long mismatches = 0;
+    for (int interval: {0, 32})
+    {
+        const char* path = "/tmp/antwar_replay.bin";
+        std::vector<std::size_t> ids(games);
+        double write_time = time_per_run(1, [&] {
+            ReplayWriter writer(path, interval);
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; ++t)
+                workers.emplace_back([&, t] {
+                    for (int i = t; i < games; i += threads)
+                        ids[i] = writer.append(recorded[i]);
+                });
+            for (auto& w: workers)
+                w.join();
+        });
+        std::ifstream size_of(path, std::ios::binary | std::ios::ate);
+        double bytes = static_cast<double>(size_of.tellg()) / games;
+        std::string suffix = interval ? ".keyframes" + std::to_string(interval) : "";
+        report(("replay.bytes" + suffix).c_str(), bytes, "bytes/game");
+        report(("replay.append" + suffix).c_str(), write_time / games, "us/game");
+
+        ReplayReader reader(path);
+        mismatches += reader.size() != static_cast<std::size_t>(games);
+        int next = 0;
+        double decode_time = time_per_run(games, [&] {
+            int id = next++;
+            ReplayGame game = reader.game(ids[id]);
+            bool same = game.seed == recorded[id].seed && game.state == recorded[id].state &&
+                        game.rounds.size() == recorded[id].rounds.size();
+            for (std::size_t r = 0; same && r < game.rounds.size(); ++r)
+                for (int p = 0; p < 2; ++p)
+                {
+                    auto& a = game.rounds[r].operations[p];
+                    auto& b = recorded[id].rounds[r].operations[p];
+                    same = same && a.size() == b.size();
+                    for (std::size_t k = 0; same && k < a.size(); ++k)
+                        same = a[k].type == b[k].type && a[k].arg0 == b[k].arg0 && a[k].arg1 == b[k].arg1;
+                }
+            mismatches += !same;
+        });
+        report(("replay.decode" + suffix).c_str(), decode_time, "us/game");
+
+        // States at random rounds, against a replay from the start
+        Random random(7);
+        std::vector<std::pair<int, int>> queries;
+        for (int i = 0; i < 50; ++i)
+        {
+            int id = random.get() % games;
+            queries.emplace_back(id, random.get() % (recorded[id].rounds.size() + 1));
+        }
+        std::vector<std::uint64_t> hashes;
+        double state_time = time_per_run(1, [&] {
+            for (auto& q: queries)
+                hashes.push_back(reader.state(ids[q.first], q.second).hash());
+        });
+        report(("replay.state" + suffix).c_str(), state_time / queries.size(), "us/query");
+        for (std::size_t i = 0; i < queries.size(); ++i)
+        {
+            const ReplayGame& game = recorded[queries[i].first];
+            Simulator s(GameInfo{game.seed});
+            for (int r = 0; r < queries[i].second; ++r)
+                ReplayFormat::replay_round(s, game.rounds[r]);
+            mismatches += s.get_info().hash() != hashes[i];
+        }
+        std::remove(path);
+    }
+    std::fprintf(stderr, "%d games, %lld mismatches\n", games, mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
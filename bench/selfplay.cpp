@@ -0,0 +1,92 @@
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstdio>
+#include <thread>
+#include "bench.hpp"
+#include "../include/selfplay.hpp"
+
+// Distributed self-play on localhost: a coordinator and 1, 2, 4, ... worker processes connected over
+// TCP, against the same games played in-process. Results must be identical, and time per game
+// should shrink with workers as long as there are cores for them.
+// Usage: selfplay [games] [max_workers]
+int main(int argc, char* argv[])
+{
+    int games = int_arg(argc, argv, 1, 256);
+    int max_workers = int_arg(argc, argv, 2, 4);
+
+    AI idle = [](int, const GameInfo&)
+    {
+        return std::vector<Operation>();
+    };
+    SelfPlayWorker::Registry ais = {{"scripted", scripted_ai}, {"idle", idle}};
+    std::vector<SelfPlayMatch> matches = {{"scripted", "scripted", 1, games}, {"scripted", "idle", 1, games / 8}};
+
+    std::vector<std::vector<SelfPlayGame>> expected;
+    double local_time = time_per_run(1, [&] {
+        for (auto& match: matches)
+        {
+            expected.emplace_back();
+            for (int i = 0; i < match.games; ++i)
+            {
+                SelfPlayGame game;
+                game.state = play_game(match.ai0 == "idle" ? idle : scripted_ai, match.ai1 == "idle" ? idle : scripted_ai,
+                    match.first_seed + i, [&game](const GameInfo& info)
+                {
+                    game.rounds = info.round;
+                    game.base_hp[0] = info.bases[0].hp;
+                    game.base_hp[1] = info.bases[1].hp;
+                });
+                expected.back().push_back(game);
+            }
+        }
+    });
+    int total = games + games / 8;
+    report("selfplay.in_process", local_time / total, "us/game");
+
+    int mismatches = 0;
+    double one_worker_time = 0;
+    for (int workers = 1; workers <= max_workers; workers *= 2)
+    {
+        std::vector<pid_t> children;
+        SelfPlayReport result;
+        double time;
+        {
+            SelfPlayCoordinator coordinator;
+            coordinator.listen();
+            for (int w = 0; w < workers; ++w)
+            {
+                pid_t pid = fork();
+                if (pid == 0)
+                {
+                    SelfPlayWorker(ais).run("127.0.0.1", coordinator.port());
+                    _exit(0);
+                }
+                children.push_back(pid);
+            }
+            time = time_per_run(1, [&] {
+                result = coordinator.run(matches);
+            });
+        }
+        for (pid_t pid: children)
+            waitpid(pid, nullptr, 0);
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "selfplay.workers%d", workers);
+        report(name, time / total, "us/game");
+        if (workers == 1)
+            one_worker_time = time;
+        for (std::size_t m = 0; m < matches.size(); ++m)
+            for (int i = 0; i < matches[m].games; ++i)
+            {
+                const SelfPlayGame& a = result.games[m][i];
+                const SelfPlayGame& b = expected[m][i];
+                mismatches += a.state != b.state || a.rounds != b.rounds || a.base_hp[0] != b.base_hp[0] ||
+                              a.base_hp[1] != b.base_hp[1];
+            }
+        std::fprintf(stderr, "%d workers: speedup %.2f over 1 worker, %d requeued\n", workers,
+            one_worker_time / time, result.requeued);
+    }
+    std::fprintf(stderr, "%d games per run, %u hardware threads, %d mismatches\n", total,
+        std::thread::hardware_concurrency(), mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
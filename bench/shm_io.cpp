@@ -0,0 +1,99 @@
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include "bench.hpp"
+
+// Round trips between a judger and a bot process over pipes with the text protocol, against the
+// shared-memory transport of io.hpp. The bot is a forked child that reads round info and replies
+// with operations through the functions of io.hpp, as Controller does; the judger side sends a
+// typical mid-game round info and reads the reply.
+// Usage: shm_io [round_trips]
+
+/**
+ * @brief Loop of the forked bot: read round info and reply with fixed operations.
+ */
+[[noreturn]] void run_bot(int round_trips, const std::vector<Operation>& reply)
+{
+    for (int i = 0; i < round_trips; ++i)
+    {
+        read_round_info();
+        send_operations(reply);
+    }
+    std::cout.flush();
+    _exit(0);
+}
+
+int main(int argc, char* argv[])
+{
+    int round_trips = int_arg(argc, argv, 1, 20000);
+
+    GameInfo state = scripted_state(42, 200);
+    RoundInfo info{state.round, state.towers, state.ants, state.coins[0], state.coins[1], state.bases[0].hp, state.bases[1].hp};
+    std::vector<Operation> reply = scripted_ai(0, state);
+    std::ostringstream text;
+    text << info.round << '\n' << info.towers.size() << '\n';
+    for (const Tower& t: info.towers)
+        text << t.id << ' ' << t.player << ' ' << t.x << ' ' << t.y << ' ' << t.type << ' ' << t.cd << '\n';
+    text << info.ants.size() << '\n';
+    for (const Ant& a: info.ants)
+        text << a.id << ' ' << a.player << ' ' << a.x << ' ' << a.y << ' ' << a.hp << ' ' << a.level << ' ' << a.age << ' ' << a.state << '\n';
+    text << info.coin0 << ' ' << info.coin1 << '\n' << info.hp0 << ' ' << info.hp1 << '\n';
+    std::string message = text.str();
+    std::fprintf(stderr, "%zu towers, %zu ants, %zu bytes of text, %zu operations\n",
+        info.towers.size(), info.ants.size(), message.size(), reply.size());
+
+    // Pipes and text
+    int to_bot[2], from_bot[2];
+    if (pipe(to_bot) || pipe(from_bot))
+        return 1;
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        dup2(to_bot[0], STDIN_FILENO);
+        dup2(from_bot[1], STDOUT_FILENO);
+        run_bot(round_trips, reply);
+    }
+    close(to_bot[0]);
+    close(from_bot[1]);
+    std::size_t received = 0;
+    double pipe_time = time_per_run(round_trips, [&] {
+        if (write(to_bot[1], message.data(), message.size()) != static_cast<ssize_t>(message.size()))
+            std::exit(1);
+        unsigned char header[4];
+        for (std::size_t got = 0; got < 4;)
+            got += std::max<ssize_t>(0, read(from_bot[0], header + got, 4 - got));
+        std::string body(header[0] << 24 | header[1] << 16 | header[2] << 8 | header[3], '\0');
+        for (std::size_t got = 0; got < body.size();)
+            got += std::max<ssize_t>(0, read(from_bot[0], &body[got], body.size() - got));
+        std::istringstream in(body);
+        received += read_opponent_operations(in).size();
+    });
+    waitpid(pid, nullptr, 0);
+    report("io.pipe.round_trip", pipe_time, "us/round-trip");
+
+    // Shared memory
+    std::string path = "/dev/shm/antwar-bench-" + std::to_string(getpid());
+    auto shm = ShmTransport::create(path);
+    if (!shm)
+        return 1;
+    pid = fork();
+    if (pid == 0)
+    {
+        setenv("ANTWAR_SHM", path.c_str(), 1);
+        run_bot(round_trips, reply);
+    }
+    std::vector<Operation> ops;
+    double shm_time = time_per_run(round_trips, [&] {
+        shm->send_round_info(info);
+        shm->read_operations(ops);
+        received += ops.size();
+    });
+    waitpid(pid, nullptr, 0);
+    report("io.shm.round_trip", shm_time, "us/round-trip");
+
+    std::fprintf(stderr, "%.0f round trips/s over pipes, %.0f over shared memory\n", 1e6 / pipe_time, 1e6 / shm_time);
+    return received == 2 * reply.size() * round_trips ? 0 : 1;
+}
@@ -0,0 +1,61 @@
+#include "bench.hpp"
+
+// Benchmarks of the simulation core
+// Usage: simulation [games] [rollouts]
+int main(int argc, char* argv[])
+{
+    int games = int_arg(argc, argv, 1, 20);
+    int rollouts = int_arg(argc, argv, 2, 2000);
+
+    // Whole self-play games
+    unsigned long long seed = 0;
+    double game_time = time_per_run(games, [&] {
+        play_game(scripted_ai, scripted_ai, ++seed);
+    });
+    report("selfplay.game", game_time, "us/game");
+
+    // Short rollouts from a mid-game root, as in a typical search
+    GameInfo root = scripted_state(42, 200);
+    int checksum = 0;
+    double rollout_time = time_per_run(rollouts, [&] {
+        Simulator s(root);
+        for (int i = 0; i < 10; ++i)
+        {
+            for (int player = 0; player < 2; ++player)
+            {
+                for (auto& op: scripted_ai(player, s.get_info()))
+                    s.add_operation_of_player(player, op);
+                s.apply_operations_of_player(player);
+            }
+            if (s.next_round() != GameState::Running)
+                break;
+        }
+        checksum += s.get_info().coins[0];
+    });
+    report("rollout.10rounds", rollout_time, "us/rollout");
+
+    // Rollouts without operations, observing the state only at the end, where towers only do work
+    // in rounds they are due
+    double idle_time = time_per_run(rollouts, [&] {
+        Simulator s(root);
+        for (int i = 0; i < 10; ++i)
+        {
+            s.apply_operations_of_player(0);
+            s.apply_operations_of_player(1);
+            if (s.next_round() != GameState::Running)
+                break;
+        }
+        checksum += s.get_info().coins[0];
+    });
+    report("rollout.10rounds.idle", idle_time, "us/rollout");
+
+    // Copying a state, the first step of every rollout
+    double copy_time = time_per_run(rollouts * 10, [&] {
+        Simulator s(root);
+        checksum += s.get_info().round;
+    });
+    report("simulator.copy", copy_time, "us/copy");
+
+    std::fprintf(stderr, "checksum %d\n", checksum);
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <cmath>
+#include <cstdio>
+#include "bench.hpp"
+#include "../include/sprt.hpp"
+
+// SPRT A/B tests with known answers: scripted_ai against itself (H0 holds), against an AI that
+// never acts (H1 holds), and two noisy variants of scripted_ai of equal strength (H0 holds), whose
+// pair scores vary. Reports the time to a decision and compares the pairs played with a fixed-size
+// test of the same error rates, sized for the worst-case variance of pair scores. The noisy test is
+// repeated on disjoint seeds, and H1 must not be accepted much more often than alpha.
+// Usage: sprt [elo1] [noisy_runs]
+int main(int argc, char* argv[])
+{
+    SprtScheduler::Options options;
+    options.elo1 = int_arg(argc, argv, 1, 10);
+    int noisy_runs = int_arg(argc, argv, 2, 10);
+    if (noisy_runs < 1)
+    {
+        std::fprintf(stderr, "noisy_runs must be at least 1\n");
+        return 2;
+    }
+
+    AI idle = [](int, const GameInfo&)
+    {
+        return std::vector<Operation>();
+    };
+    // scripted_ai skipping a quarter of rounds, picked by a hash of the game state and a salt. Two
+    // salts give AIs of equal strength whose games differ with the seed, yet are reproducible.
+    auto noisy = [](unsigned long long salt) -> AI
+    {
+        return [salt](int player_id, const GameInfo& info)
+        {
+            Random random(GameInfo::hash_combine(info.hash(), salt * 2 + player_id));
+            if ((random.get() >> 17) % 4 == 0)
+                return std::vector<Operation>();
+            return scripted_ai(player_id, info);
+        };
+    };
+    struct Case
+    {
+        const char* name;
+        AI a, b;
+        SprtDecision expected;
+        int runs;
+    } cases[] = {
+        {"sprt.same", scripted_ai, scripted_ai, SprtDecision::AcceptH0, 1},
+        {"sprt.idle", scripted_ai, idle, SprtDecision::AcceptH1, 1},
+        {"sprt.noisy", noisy(1), noisy(2), SprtDecision::AcceptH0, noisy_runs},
+    };
+
+    int wrong = 0;
+    for (auto& c: cases)
+    {
+        int pairs = 0, false_h1 = 0, other = 0;
+        SprtResult result{};
+        double time = time_per_run(c.runs, [&] {
+            result = SprtScheduler(options).run(c.a, c.b);
+            options.seed += options.max_pairs;
+            pairs += result.pairs;
+            false_h1 += result.decision == SprtDecision::AcceptH1 && c.expected != SprtDecision::AcceptH1;
+            other += result.decision != c.expected;
+        });
+        report(c.name, time, "us/test");
+        // A fixed-size test needs ((z_alpha + z_beta) * sigma / (s1 - s0))^2 pairs, where the
+        // variance of a pair score is at most 1/8
+        double s0 = 0.5, s1 = 1 / (1 + std::pow(10, -options.elo1 / 400));
+        double fixed = std::pow((1.645 + 1.645) / (s1 - s0), 2) / 8;
+        std::fprintf(stderr, "%s: %d runs, last decision %d, llr %.2f, %d pairs (+%d/=%d/-%d), mean %.0f pairs, "
+            "fixed-size test ~%.0f pairs\n", c.name, c.runs, static_cast<int>(result.decision), result.llr,
+            result.pairs, result.wins, result.draws, result.losses, double(pairs) / c.runs, fixed);
+        if (c.runs == 1)
+        {
+            wrong += other;
+            continue;
+        }
+        // Runs are independent, so false acceptances of H1 are binomial: allow 3 standard deviations
+        double bound = c.runs * options.alpha + 3 * std::sqrt(c.runs * options.alpha * (1 - options.alpha));
+        std::fprintf(stderr, "%s: H1 accepted in %d of %d runs (alpha %.2f), %d runs without the expected decision\n",
+            c.name, false_h1, c.runs, options.alpha, other);
+        wrong += false_h1 > bound;
+    }
+    return wrong;
+}
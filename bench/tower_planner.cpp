@@ -0,0 +1,69 @@
+#include <cstdio>
+#include "bench.hpp"
+#include "../include/tower_planner.hpp"
+
+// Tower planning every round of a scripted game: traffic forecast, coverage sums updated
+// incrementally against rebuilt from scratch, and ranking. Only planning is timed, not the game.
+// Usage: tower_planner [rounds]
+int main(int argc, char* argv[])
+{
+    int rounds = int_arg(argc, argv, 1, 300);
+
+    // States of a scripted game, planned for in order
+    std::vector<GameInfo> states;
+    Simulator s(GameInfo{42});
+    for (int round = 0; round < rounds; ++round)
+    {
+        states.push_back(s.get_info());
+        for (int player = 0; player < 2; ++player)
+        {
+            for (auto& op: scripted_ai(player, s.get_info()))
+                s.add_operation_of_player(player, op);
+            s.apply_operations_of_player(player);
+        }
+        if (s.next_round() != GameState::Running)
+            break;
+    }
+
+    // Forecasts of all states
+    std::vector<std::vector<double>> forecasts(states.size(), std::vector<double>(MAP_CELLS));
+    double forecast_time = time_per_run(states.size(), [&] {
+        static std::size_t i = 0;
+        TowerPlanner::forecast_traffic(states[i], 0, 32, forecasts[i].data());
+        ++i;
+    });
+    report("tower_planner.forecast", forecast_time, "us/round");
+
+    // Coverage sums, updated with changed cells against rebuilt from scratch
+    disk_table(TowerPlanner::MIN_RANGE); // Build tables before timing
+    double checksum = 0;
+    long long changed = 0;
+    TowerPlanner planner(0);
+    std::size_t index = 0;
+    double incremental_time = time_per_run(states.size(), [&] {
+        changed += planner.set_traffic(forecasts[index++].data());
+        checksum += planner.coverage_of(Base::POSITION[0][0], Base::POSITION[0][1], 3);
+    });
+    report("tower_planner.coverage.incremental", incremental_time, "us/round");
+    report("tower_planner.coverage.changed_cells", static_cast<double>(changed) / states.size(), "cells/round");
+
+    index = 0;
+    double scratch_time = time_per_run(states.size(), [&] {
+        TowerPlanner fresh(0);
+        fresh.set_traffic(forecasts[index++].data());
+        checksum -= fresh.coverage_of(Base::POSITION[0][0], Base::POSITION[0][1], 3);
+    });
+    report("tower_planner.coverage.from_scratch", scratch_time, "us/round");
+
+    // Ranking, given coverage
+    index = 0;
+    double plan_time = time_per_run(states.size(), [&] {
+        planner.set_traffic(forecasts[index].data());
+        auto plans = planner.plan(states[index++], 5);
+        checksum += plans.empty() ? 0 : plans[0].score * 1e-9;
+    });
+    report("tower_planner.plan", plan_time, "us/round");
+
+    std::fprintf(stderr, "%zu rounds, checksum %.6f\n", states.size(), checksum);
+    return 0;
+}
@@ -0,0 +1,18 @@
+#define ANTWAR_TRACE
+#include "bench.hpp"
+
+// Overhead of tracing spans
+// Usage: trace [spans]
+int main(int argc, char* argv[])
+{
+    int spans = int_arg(argc, argv, 1, 1000000);
+
+    double span_time = time_per_run(spans, [] {
+        ANTWAR_TRACE_SCOPE("bench.span");
+    });
+    report("trace.span", span_time * 1000, "ns/span");
+
+    // Nothing to be written at exit
+    Tracer::instance().clear();
+    return 0;
+}
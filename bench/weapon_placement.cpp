@@ -0,0 +1,52 @@
+#include <cstdio>
+#include "bench.hpp"
+#include "../include/weapon_placement.hpp"
+
+// Super weapon placement: one sweep of the optimizer over all types and centers, against trying
+// every valid center of lightning storms through is_operation_valid() and a one-round simulation.
+// Usage: weapon_placement [runs]
+int main(int argc, char* argv[])
+{
+    int runs = int_arg(argc, argv, 1, 20000);
+    GameInfo root = scripted_state(42, 200);
+    for (int type = LightningStorm; type < SuperWeaponCount; ++type)
+        root.super_weapon_cd[0][type] = 0;
+    root.coins[0] = 1000;
+
+    WeaponPlacementOptimizer optimizer;
+    double checksum = 0;
+    double sweep_time = time_per_run(runs, [&] {
+        optimizer.evaluate(root, 0);
+        for (auto& p: optimizer.top(3))
+            checksum += p.score;
+    });
+    report("weapon_placement.sweep", sweep_time, "us/sweep");
+
+    WeaponPlacement best{LightningStorm, -1, -1, 0};
+    double brute_time = time_per_run(std::max(1, runs / 1000), [&] {
+        for (int x = 0; x < MAP_SIZE; ++x)
+            for (int y = 0; y < MAP_SIZE; ++y)
+            {
+                Operation op(UseLightningStorm, x, y);
+                if (!root.is_operation_valid(0, op))
+                    continue;
+                Simulator s(root);
+                s.add_operation_of_player(0, op);
+                s.apply_operations_of_player(0);
+                s.apply_operations_of_player(1);
+                s.next_round();
+                // Rewards of the round, with the price of the storm refunded
+                double gain = s.get_info().coins[0] - root.coins[0] + GameInfo::use_super_weapon_cost(LightningStorm);
+                if (gain > best.score)
+                    best = WeaponPlacement{LightningStorm, x, y, gain};
+            }
+    });
+    report("weapon_placement.brute_force_storm", brute_time, "us/sweep");
+
+    auto storm = optimizer.top(LightningStorm, 1);
+    if (!storm.empty())
+        std::fprintf(stderr, "storm: optimizer (%d, %d) %.1f, brute force (%d, %d) %.1f coins\n",
+            storm[0].x, storm[0].y, storm[0].score, best.x, best.y, best.score);
+    std::fprintf(stderr, "checksum %.1f\n", checksum);
+    return 0;
+}
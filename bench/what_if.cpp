@@ -0,0 +1,75 @@
+#include <cstdio>
+#include "bench.hpp"
+#include "../include/what_if.hpp"
+
+// Batch evaluation of candidate operation sets against copying a Simulator per candidate. Candidates
+// are distinct sets plus the same sets in another order, as a search without canonicalization
+// would expand them.
+// Usage: what_if [rounds] [runs]
+int main(int argc, char* argv[])
+{
+    int rounds = int_arg(argc, argv, 1, 5);
+    int runs = int_arg(argc, argv, 2, 5);
+    GameInfo root = scripted_state(42, 200);
+    root.coins[0] = 400; // Rich enough for sets of several operations
+
+    std::vector<std::vector<Operation>> candidates = distinct_operation_sets(root, 0, 2, 120);
+    std::size_t distinct = candidates.size();
+    for (std::size_t i = 0; i < distinct; ++i)
+        if (candidates[i].size() > 1)
+            candidates.emplace_back(candidates[i].rbegin(), candidates[i].rend());
+    std::vector<Operation> opponent = scripted_ai(1, root);
+
+    // One Simulator copy per candidate, every candidate simulated
+    std::vector<double> naive_scores(candidates.size());
+    double naive_time = time_per_run(runs, [&] {
+        for (std::size_t i = 0; i < candidates.size(); ++i)
+        {
+            Simulator s(root);
+            for (auto& op: candidates[i])
+                s.add_operation_of_player(0, op);
+            s.apply_operations_of_player(0);
+            for (auto& op: opponent)
+                s.add_operation_of_player(1, op);
+            s.apply_operations_of_player(1);
+            GameState state = s.next_round();
+            for (int r = 1; r < rounds && state == GameState::Running; ++r)
+            {
+                for (int p = 0; p < 2; ++p)
+                {
+                    for (auto& op: scripted_ai(p, s.get_info()))
+                        s.add_operation_of_player(p, op);
+                    s.apply_operations_of_player(p);
+                }
+                state = s.next_round();
+            }
+            naive_scores[i] = WhatIfEvaluator::default_score(s.get_info(), 0);
+        }
+    });
+    report("what_if.naive", naive_time / candidates.size(), "us/candidate");
+
+    WhatIfEvaluator::Options options;
+    options.rounds = rounds;
+    options.policy = scripted_ai;
+    long long mismatches = 0;
+    for (int threads: {1, 4})
+    {
+        options.threads = threads;
+        WhatIfEvaluator evaluator(options);
+        std::vector<WhatIfOutcome> outcomes;
+        double batch_time = time_per_run(runs, [&] {
+            outcomes = evaluator.evaluate(root, 0, opponent, candidates);
+        });
+        char name[64];
+        std::snprintf(name, sizeof(name), "what_if.batch.threads%d", threads);
+        report(name, batch_time / candidates.size(), "us/candidate");
+        // Candidates enumerated in canonical order must match the naive simulation
+        for (std::size_t i = 0; i < distinct; ++i)
+            mismatches += outcomes[i].state == GameState::Running && outcomes[i].score != naive_scores[i];
+        if (threads == 1)
+            std::fprintf(stderr, "%zu candidates, %zu distinct\n", candidates.size(), evaluator.get_distinct_count());
+    }
+
+    std::fprintf(stderr, "%lld mismatches\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+#include "../include/control.hpp"
+#include "../include/async_io.hpp"
+#include <cstdlib>
+
+// Construct a Controller object and initialize it
+Controller c;
+// Read the rest of judger messages in background
+AsyncReader reader;
+
+// Placeholder for background thinking, e.g. a few more iterations of a search
+long long thoughts = 0;
+void think_a_bit_more()
+{
+    ++thoughts;
+}
+
+// Wait for opponent operations and apply them, thinking in the meantime
+void receive_opponent_operations()
+{
+    std::vector<Operation> ops;
+    while (!reader.try_read_opponent_operations(ops))
+    {
+        if (reader.closed())
+            std::exit(0);
+        think_a_bit_more();
+    }
+    c.set_opponent_operations(std::move(ops));
+    c.apply_opponent_operations(); // Apply opponent operations to game state
+}
+
+// Wait for round data and update game state, thinking in the meantime
+void receive_round_info()
+{
+    RoundInfo info;
+    while (!reader.try_read_round_info(info))
+    {
+        if (reader.closed())
+            std::exit(0);
+        think_a_bit_more();
+    }
+    c.update_round_info(info);
+}
+
+// Add, send and apply your operations
+void play(int x)
+{
+    // Add your operations here
+    c.append_self_operation(BuildTower, x, 9);
+    c.append_self_operation(BuildTower, x, 3);
+    c.append_self_operation(BuildTower, x, 15);
+    c.send_self_operations(); // Send your operations to judger
+    c.apply_self_operations(); // Apply your operations to game state
+}
+
+int main()
+{
+    while (true)
+    {
+        // Player 0 moves first, while player 1 waits for opponent operations first
+        if (c.self_player_id == 0)
+        {
+            play(5);
+            receive_opponent_operations();
+        }
+        else
+        {
+            receive_opponent_operations();
+            play(13);
+        }
+        receive_round_info();
+        std::cerr << "round " << c.get_info().round << ": " << thoughts << " thoughts so far" << std::endl;
+    }
+}
@@ -0,0 +1,59 @@
+#include "../include/coroutine.hpp"
+#include "../include/simulate.hpp"
+
+// A bot written as a coroutine (requires C++20, see Makefile). It tries building a tower at each
+// highland of its own in turn, evaluates each choice with a short simulation, and publishes the
+// best one found so far until time is up. Between turns it simply waits.
+
+// Score a decision by simulating a few rounds in which nobody does anything else
+int evaluate(const GameInfo& info, int player, const std::vector<Operation>& ops)
+{
+    Simulator s(info);
+    for (auto& op: ops)
+        s.add_operation_of_player(player, op);
+    s.apply_operations_of_player(player);
+    for (int i = 0; i < 5; ++i)
+    {
+        if (player == 0)
+            s.apply_operations_of_player(1);
+        if (s.next_round() != GameState::Running)
+            break;
+        if (player == 1)
+            s.apply_operations_of_player(0);
+    }
+    const GameInfo& result = s.get_info();
+    return (result.bases[player].hp - result.bases[!player].hp) * 100 + result.coins[player];
+}
+
+BotTask bot(BotContext& context)
+{
+    while (true)
+    {
+        const GameInfo& info = co_await context.next_turn();
+        int player = context.player();
+        std::vector<Operation> best;
+        int best_score = evaluate(info, player, best);
+        // Publish the best decision after each try, and give up when time is up
+        bool keep_going = co_yield best;
+        for (int cell = 0; keep_going && cell < MAP_SIZE * MAP_SIZE; ++cell)
+        {
+            int x = cell / MAP_SIZE, y = cell % MAP_SIZE;
+            if (!is_highland(player, x, y) || !info.is_operation_valid(player, Operation(BuildTower, x, y)))
+                continue;
+            std::vector<Operation> ops{Operation(BuildTower, x, y)};
+            int score = evaluate(info, player, ops);
+            if (score > best_score)
+            {
+                best_score = score;
+                best = ops;
+            }
+            keep_going = co_yield best;
+        }
+    }
+}
+
+int main()
+{
+    run_with_coroutine(bot, std::chrono::milliseconds(200));
+    return 0;
+}
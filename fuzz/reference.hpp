@@ -0,0 +1,1110 @@
+/**
+ * @file reference.hpp
+ * @author Yufei Li, Jingxuan Liu
+ * @brief A frozen copy of the straightforward simulation logic, used as the oracle of fuzzing.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * @note DO NOT optimize or refactor anything here. This is the game logic as it was before any
+ * optimization of the engine, and it only changes when the rules change. Map data, static
+ * information and plain data types (Operation, Random, enumerations) are shared with the engine.
+ */
+
+#pragma once
+
+#include "../include/simulate.hpp"
+
+namespace reference
+{
+
+inline int distance(int x0, int y0, int x1, int y1)
+{
+    int dy = abs(y0 - y1);
+    int dx;
+    if (abs(y0 - y1) % 2)
+    {
+        if (x0 > x1)
+            dx = std::max(0, abs(x0 - x1) - abs(y0 - y1) / 2 - (y0 % 2));
+        else
+            dx = std::max(0, abs(x0 - x1) - abs(y0 - y1) / 2 - (1 - (y0 % 2)));
+    }
+    else
+        dx = std::max(0, abs(x0 - x1) - abs(y0 - y1) / 2);
+
+    return dx + dy;
+}
+
+inline bool is_valid_pos(int x, int y)
+{
+    if (x < 0 || x >= MAP_SIZE || y < 0 || y >= MAP_SIZE)
+        return false;
+    return MAP_PROPERTY[x][y] != PointType::Void;
+}
+
+inline bool is_path(int x, int y)
+{
+    if (x < 0 || x >= MAP_SIZE || y < 0 || y >= MAP_SIZE)
+        return false;
+    return MAP_PROPERTY[x][y] == PointType::Path;
+}
+
+inline bool is_highland(int player, int x, int y)
+{
+    if (x < 0 || x >= MAP_SIZE || y < 0 || y >= MAP_SIZE)
+        return false;
+    return MAP_PROPERTY[x][y] == (player == 0 ? PointType::Player0Highland : PointType::Player1Highland);
+}
+
+inline int get_direction(int x0, int y0, int x1, int y1)
+{
+    int dx = x1 - x0;
+    int dy = y1 - y0;
+    for (int i = 0; i < 6; ++i)
+    {
+        if (OFFSET[y0 % 2][i][0] == dx && OFFSET[y0 % 2][i][1] == dy)
+            return i;
+    }
+    return -1;
+}
+
+struct Ant
+{
+    // Attributes
+    int id, player;
+    int x, y;
+    int hp, level, age;
+    AntState state;
+    std::vector<int> path;
+    int evasion; // tag for emergency evasion
+    bool deflector;  // tag for deflector
+    // Static info
+    static constexpr int AGE_LIMIT = 32;
+    static constexpr int MAX_HP_INFO[] = {10, 25, 50}; // Max HP of an ant of certain level
+    static constexpr int REWARD_INFO[] = {3, 5, 7};    // Reward for killing an ant of certain level
+
+    Ant(int id, int player, int x, int y, int hp, int level, int age, AntState state)
+        : id(id), player(player), x(x), y(y), hp(hp), level(level), age(age), state(state), evasion(0), deflector(false) {}
+    
+    void move(int direction)
+    {
+        path.push_back(direction);
+        x += OFFSET[y % 2][direction][0];
+        y += OFFSET[y % 2][direction][1];
+    }
+
+    int max_hp() const
+    {
+        return MAX_HP_INFO[level];
+    }
+
+    int reward() const
+    {
+        return REWARD_INFO[level];
+    }
+
+    bool is_alive() const
+    {
+        return state == AntState::Alive || state == AntState::Frozen;
+    }
+
+    bool is_in_range(int x, int y, int range) const
+    {
+        return distance(this->x, this->y, x, y) <= range;
+    }
+
+    bool is_attackable_from(int player, int x, int y, int range) const
+    {
+        return this->player != player && is_alive() && is_in_range(x, y, range);
+    }
+};
+
+constexpr int Ant::MAX_HP_INFO[];
+constexpr int Ant::REWARD_INFO[];
+
+struct Tower
+{
+    int id, player;
+    int x, y;
+    TowerType type;
+    int damage, range;
+    int cd;
+    double speed;
+
+    Tower(int id, int player, int x, int y, TowerType type = TowerType::Basic, int cd = -1)
+        : id(id), player(player), x(x), y(y), type(type), cd(cd)
+    {
+        upgrade(type); // CD is reset to the max
+        if (cd != -1) // If CD is given
+            this->cd = cd;
+    }
+    std::vector<int> attack(std::vector<Ant>& ants)
+    {
+        std::vector<int> attacked_idxs;
+        // Count down CD
+        cd = std::max(cd - 1, 0);
+        if (cd <= 0) // Ready to attack
+        {
+            // How many times the tower will try to find targets in this turn
+            int time = speed >= 1 ? 1 : (1 / speed);
+            // How many targets the tower should find each time (maybe less than required number)
+            int target_num = type == Double ? 2 : 1;
+            // Find and action
+            while (time--)
+            {
+                std::vector<int> target_idxs = find_targets(ants, target_num);
+                std::vector<int> attackable_idxs = find_attackable(ants, target_idxs);
+                for (int idx: attackable_idxs)
+                    action(ants[idx]);
+                attacked_idxs.insert(attacked_idxs.end(), attackable_idxs.begin(), attackable_idxs.end());
+            }
+            // Uniquify to prevent multiple occurances of the same ant
+            std::sort(attacked_idxs.begin(), attacked_idxs.end());
+            attacked_idxs.erase(std::unique(attacked_idxs.begin(), attacked_idxs.end()), attacked_idxs.end());
+            // Reset CD if really attacks
+            if (!attacked_idxs.empty())
+                reset_cd();
+        }
+        return attacked_idxs;
+    }
+
+    std::vector<int> find_targets(const std::vector<Ant>& ants, int target_num) const
+    {
+        // Initialize index array for reference
+        std::vector<int> idxs = get_attackable_ants(ants, x, y, range);
+        // Partial sort to get first n elements
+        auto bound = target_num <= idxs.size() ? (idxs.begin() + target_num) : idxs.end();
+        std::partial_sort(idxs.begin(), bound, idxs.end(), [&] (int i, int j) {
+            int dist1 = distance(ants[i].x, ants[i].y, x, y),
+                dist2 = distance(ants[j].x, ants[j].y, x, y);
+            if (dist1 != dist2)
+                return dist1 < dist2;
+            else
+                return i < j;
+        });
+        // Get first n elements
+        if (idxs.size() > target_num)
+            idxs.resize(target_num);
+        return idxs;
+    }
+
+    std::vector<int> find_attackable(const std::vector<Ant>& ants, const std::vector<int>& target_idxs) const
+    {
+        std::vector<int> attackable_idxs;
+        for (int idx: target_idxs)
+        {
+            std::vector<int> tmp;
+            switch (type)
+            {
+                case Mortar:
+                    tmp = get_attackable_ants(ants, ants[idx].x, ants[idx].y, 1);
+                    break;
+                case MortarPlus:
+                    tmp = get_attackable_ants(ants, ants[idx].x, ants[idx].y, 1);
+                    break;
+                case Pulse:
+                    tmp = get_attackable_ants(ants, x, y, range);
+                    break;
+                case Missile:
+                    tmp = get_attackable_ants(ants, ants[idx].x, ants[idx].y, 2);
+                    break;
+                default:
+                    tmp = {idx};
+            }
+            attackable_idxs.insert(attackable_idxs.end(), tmp.begin(), tmp.end());
+        }
+        return attackable_idxs;
+    }
+
+    void action(Ant& ant) const
+    {
+        if (ant.evasion > 0)  // evasion effect
+            ant.evasion--;  // count down times
+        else if (ant.deflector && damage < ant.max_hp() / 2) // deflector effect
+            return; // get no damage
+        else // normal condition
+        {
+            ant.hp -= damage;
+            if (type == Ice)
+                ant.state = AntState::Frozen;
+            if (ant.hp <= 0)
+                ant.state = AntState::Fail;
+        }
+    }
+
+    std::vector<int> get_attackable_ants(const std::vector<Ant>& ants, int x, int y, int range) const
+    {
+        std::vector<int> idxs;
+        for (int i = 0; i < ants.size(); ++i)
+            if (ants[i].is_attackable_from(player, x, y, range))
+                idxs.push_back(i);
+        return idxs;
+    }
+
+    bool is_ready() const
+    {
+        return cd <= 0;
+    }
+
+    void reset_cd()
+    {
+        cd = speed > 1 ? speed : 1;
+    }
+
+    void upgrade(TowerType new_type)
+    {
+        type = new_type;
+        damage = TOWER_INFO[new_type].attack;
+        speed = TOWER_INFO[new_type].speed;
+        range = TOWER_INFO[new_type].range;
+        reset_cd(); // Reset when `speed` has changed
+    }
+
+    bool is_upgrade_type_valid(int type) const
+    {
+        if (type < TowerType::Basic || type > TowerType::Missile)
+            return false;
+        switch (this->type)
+        {
+            case TowerType::Basic:
+                return type == TowerType::Heavy || type == TowerType::Quick || type == TowerType::Mortar;
+            case TowerType::Heavy:
+                return type == TowerType::HeavyPlus || type == TowerType::Ice || type == TowerType::Cannon;
+            case TowerType::Quick:
+                return type == TowerType::QuickPlus || type == TowerType::Double || type == TowerType::Sniper;
+            case TowerType::Mortar:
+                return type == TowerType::MortarPlus || type == TowerType::Pulse || type == TowerType::Missile;
+        }
+        return false;
+    }
+
+    void downgrade()
+    {
+        type = static_cast<TowerType>(type / 10);
+        damage = TOWER_INFO[type].attack;
+        speed = TOWER_INFO[type].speed;
+        range = TOWER_INFO[type].range;
+        reset_cd(); // Reset when `speed` has changed
+    }
+
+    bool is_downgrade_valid() const
+    {
+        return type != TowerType::Basic;
+    }
+};
+
+struct Base
+{
+    // Attributes
+    const int player, x, y;
+    int hp;
+    int gen_speed_level;
+    int ant_level;
+    // Static info
+    static constexpr int MAX_HP = 50;
+    static constexpr int POSITION[2][2] = {{2, EDGE - 1},  {(MAP_SIZE - 1) - 2, EDGE - 1}};
+    static constexpr int GENERATION_CYCLE_INFO[] = {4, 2, 1};
+    
+    Base(int player)
+        : player(player), x(POSITION[player][0]), y(POSITION[player][1]), hp(MAX_HP),
+          gen_speed_level(0), ant_level(0) {}
+
+    optional<Ant> generate_ant(int id, int round)
+    {
+        return round % GENERATION_CYCLE_INFO[gen_speed_level] == 0
+            ? make_optional(Ant(
+                id, player, x, y,
+                Ant::MAX_HP_INFO[ant_level], ant_level,
+                0, AntState::Alive
+            ))
+            : nullopt;
+    }
+
+    void upgrade_generation_speed()
+    {
+        gen_speed_level++;
+    }
+
+    void upgrade_generated_ant()
+    {
+        ant_level++;
+    }
+};
+
+constexpr int Base::POSITION[2][2];
+constexpr int Base::GENERATION_CYCLE_INFO[];
+
+struct SuperWeapon
+{
+    SuperWeaponType type;
+    int player;
+    int x, y;
+    int left_time;
+    int range;
+
+    SuperWeapon(SuperWeaponType type, int player, int x, int y) : 
+        type(type), player(player), x(x), y(y), left_time(SUPER_WEAPON_INFO[type][0]), range(SUPER_WEAPON_INFO[type][1]) {}
+
+    bool is_in_range(int x, int y) const
+    {
+        return distance(x, y, this->x, this->y) <= range;
+    }
+};
+
+struct GameInfo
+{
+    int round;
+    std::vector<Tower> towers;
+    std::vector<Ant> ants;
+    Base bases[2];
+    int coins[2];
+    double pheromone[2][MAP_SIZE][MAP_SIZE];
+    std::vector<SuperWeapon> super_weapons;
+    int super_weapon_cd[2][SuperWeaponCount];
+    
+    int next_ant_id;
+    int next_tower_id;
+
+    GameInfo(unsigned long long seed)
+        : round(0), bases{Base(0), Base(1)}, coins{COIN_INIT, COIN_INIT},
+          super_weapon_cd{}, next_ant_id(0), next_tower_id(0)
+    {
+        // Initialize pheromone
+        Random random(seed);
+        for(int i = 0; i < 2; i++)
+            for(int j = 0; j < MAP_SIZE; j++)
+                for(int k = 0; k < MAP_SIZE; k++)
+                    pheromone[i][j][k] = random.get() * std::pow(2, -46) + 8;
+    }
+
+    template<typename T, typename Pred>
+    optional<T> find_one(const std::vector<T>& v, Pred pred) const
+    {
+        auto it = std::find_if(v.begin(), v.end(), pred);
+        if (it != v.end())
+            return make_optional<T>(*it);
+        else
+            return nullopt;
+    }
+    
+    template<typename T, typename Pred>
+    std::vector<T> find_all(const std::vector<T>& v, Pred pred) const
+    {
+        std::vector<T> fit_elems;
+        for (const T& e: v)
+            if (pred(e))
+                fit_elems.emplace_back(e);
+        return fit_elems;
+    }
+
+    // Ant
+    
+    std::vector<Ant> all_ants() const
+    {
+        return ants;
+    }
+
+    std::vector<Ant> ant_at(int x, int y) const
+    {
+        return find_all(ants, [x, y](const Ant &a){ return a.x == x && a.y == y; });
+    }
+
+    optional<Ant> ant_of_id(int id) const
+    {
+        return find_one(ants, [id](const Ant &a) { return a.id == id; });
+    }
+
+    int ant_of_id_by_index(int id) const
+    {
+        auto it = std::find_if(ants.begin(), ants.end(), [&](const Ant &a)
+                               { return a.id == id; });
+        if (it != ants.end())
+            return it - ants.begin();
+        else
+            return -1;
+    }
+
+    // Tower
+    
+    std::vector<Tower> all_towers() const
+    {
+        return towers;
+    }
+
+    optional<Tower> tower_at(int x, int y) const
+    {
+        return find_one(
+            towers, [x, y](const Tower &t) { return t.x == x && t.y == y; });
+    }
+
+    optional<Tower> tower_of_id(int id) const
+    {
+        return find_one(
+            towers, [id](const Tower &t) { return t.id == id; });
+    }
+
+    void build_tower(int id, int player, int x, int y, TowerType type = TowerType::Basic)
+    {
+        towers.emplace_back(id, player, x, y, type);
+    }
+
+    void upgrade_tower(int id, TowerType type)
+    {
+        auto it = std::find_if(towers.begin(), towers.end(), [&](const Tower &t)
+                               { return t.id == id; });
+        if (it != towers.end())
+        {
+            it->upgrade(type);
+        }
+    }
+
+    void downgrade_or_destroy_tower(int id)
+    {
+        auto it = std::find_if(towers.begin(), towers.end(), [&](const Tower &t)
+                               { return t.id == id; });
+        if (it != towers.end())
+        {
+            if (it->is_downgrade_valid()) // Downgrade
+                it->downgrade();
+            else // Destroy
+                towers.erase(it);
+        }
+    }
+
+    void upgrade_generation_speed(int player_id)
+    {
+        bases[player_id].upgrade_generation_speed();
+    }
+
+    void upgrade_generated_ant(int player_id)
+    {
+        bases[player_id].upgrade_generated_ant();
+    }
+
+    void set_coin(int player_id, int value)
+    {
+        coins[player_id] = value;
+    }
+
+    void update_coin(int player_id, int change)
+    {
+        coins[player_id] += change;
+    }
+
+    void set_base_hp(int player_id, int value)
+    {
+        bases[player_id].hp = value;
+    }
+
+    void update_base_hp(int player_id, int change)
+    {
+        bases[player_id].hp += change;
+    }
+
+    void clear_dead_and_succeeded_ants()
+    {
+        for (auto it = ants.begin(); it != ants.end();)
+        {
+            if (it->state == AntState::Success || it->state == AntState::Fail || it->state == AntState::TooOld)
+                it = ants.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    void update_pheromone_for_ants()
+    {
+        for (const Ant& ant : ants)
+            update_pheromone(ant);
+    }
+
+    void update_pheromone(const Ant &ant)
+    {
+        // Parameters for the algorithm
+        static constexpr double TAU[] = {0.0, 10.0, -5, -3};
+        
+        // Do nothing if the ant is alive or frozen
+        if (ant.state == AntState::Alive || ant.state == AntState::Frozen)
+            return;
+        
+        // Update pheromone from start to end
+        int tau = TAU[ant.state];
+        int player = ant.player;
+        int x = Base::POSITION[player][0], y = Base::POSITION[player][1];
+        bool visited[MAP_SIZE][MAP_SIZE] = {};
+        
+        for (int move: ant.path)
+        {
+            // If not visited yet
+            if (!visited[x][y])
+            {
+                visited[x][y] = true; // Mark on the map
+                pheromone[player][x][y] += tau; // Update pheromone
+                if (pheromone[player][x][y] < PHEROMONE_MIN) // No underflow
+                    pheromone[player][x][y] = PHEROMONE_MIN;
+            }
+            // Move to next position
+            x += OFFSET[y % 2][move][0];
+            y += OFFSET[y % 2][move][1];
+        }
+
+        // Should have reached the end now
+        assert(x == ant.x && y == ant.y);
+        if (!visited[x][y]) // Update at the current position if not visited yet
+        {
+            pheromone[player][x][y] += tau;
+            if (pheromone[player][x][y] < PHEROMONE_MIN)
+                pheromone[player][x][y] = PHEROMONE_MIN;
+        }
+    }
+
+    void global_pheromone_attenuation()
+    {
+        for (int i = 0; i < 2; ++i)
+            for (int j = 0; j < MAP_SIZE; ++j)
+                for (int k = 0; k < MAP_SIZE; ++k)
+                    pheromone[i][j][k] =
+                        PHEROMONE_ATTENUATING_RATIO * pheromone[i][j][k]
+                        + (1 - PHEROMONE_ATTENUATING_RATIO) * PHEROMONE_INIT;
+    }
+
+    int tower_num_of_player(int player_id) const
+    {
+        return std::count_if(
+            towers.begin(),
+            towers.end(),
+            [player_id](const Tower& tower) {
+                return tower.player == player_id;
+            }
+        );
+    }
+
+    bool is_operation_valid(int player_id, const Operation& op) const
+    {
+        switch (op.type)
+        {
+            case BuildTower:
+                return is_highland(player_id, op.arg0, op.arg1)
+                       && !tower_at(op.arg0, op.arg1)
+                       && !is_shielded_by_emp(player_id, op.arg0, op.arg1);
+            case UpgradeTower:
+            {
+                auto t = tower_of_id(op.arg0);
+                return t && t.value().player == player_id
+                       && t.value().is_upgrade_type_valid(op.arg1) 
+                       && !is_shielded_by_emp(t.value());
+            }
+            case DowngradeTower:
+            {
+                auto t = tower_of_id(op.arg0);
+                return t && t.value().player == player_id
+                       && !is_shielded_by_emp(t.value());
+            }
+            case UseLightningStorm:
+            case UseEmpBlaster:
+            case UseDeflector:
+            case UseEmergencyEvasion:
+                return  is_valid_pos(op.arg0, op.arg1)
+                        && super_weapon_cd[player_id][op.type % 10] <= 0;
+            case UpgradeGenerationSpeed:
+                return bases[player_id].gen_speed_level < 2;
+            case UpgradeGeneratedAnt:
+                return bases[player_id].ant_level < 2;
+            default:
+                return false;
+        }
+    }
+
+    bool is_operation_valid(int player_id, const std::vector<Operation>& ops, const Operation& new_op) const
+    {
+        // Check if there are multiple operations of the same type
+        bool collide = false;
+        switch (new_op.type)
+        {
+            // At specified position only one tower can be built
+            case OperationType::BuildTower:
+                collide = std::any_of(ops.begin(), ops.end(), [&](const Operation& op) {
+                    return op.type == BuildTower && op.arg0 == new_op.arg0 && op.arg1 == new_op.arg1;
+                });
+                break;
+            // A tower can only be upgraded/downgraded once
+            case OperationType::UpgradeTower:
+            case OperationType::DowngradeTower:
+                collide = std::any_of(ops.begin(), ops.end(), [&](const Operation& op) {
+                    return (op.type == UpgradeTower || op.type == DowngradeTower) && op.arg0 == new_op.arg0;
+                });
+                break;
+            // Base can only be upgraded once
+            case OperationType::UpgradeGeneratedAnt:
+            case OperationType::UpgradeGenerationSpeed:
+                collide = std::any_of(ops.begin(), ops.end(), [&](const Operation& op) {
+                    return op.type == UpgradeGeneratedAnt || op.type == UpgradeGenerationSpeed;
+                });
+                break;
+            // Super weapon of specified type can only be used once
+            case OperationType::UseLightningStorm:
+            case OperationType::UseEmpBlaster:
+            case OperationType::UseDeflector:
+            case OperationType::UseEmergencyEvasion:
+                collide = std::any_of(ops.begin(), ops.end(), [&](const Operation& op) {
+                    return op.type == new_op.type;
+                });
+                break;
+            // Illegal operation type
+            default:
+                return false;
+        }
+        if (collide)
+            return false;
+
+        // Check operation validness
+        if (!is_operation_valid(player_id, new_op))
+            return false;
+        
+        // Check if the player has enough coins
+        std::vector<Operation> new_ops(ops);
+        new_ops.push_back(new_op);
+        if (!check_affordable(player_id, new_ops))
+            return false;
+
+        // Pass all checks. The operation has been added successfully.
+        return true;
+    }
+
+    int get_operation_income(int player_id, const Operation& op) const
+    {
+        switch (op.type)
+        {
+            case BuildTower:
+                return -build_tower_cost(tower_num_of_player(player_id));
+            case UpgradeTower:
+                return -upgrade_tower_cost(op.arg1);
+            case DowngradeTower:
+            {
+                auto t = tower_of_id(op.arg0);
+                if (t.value().type == TowerType::Basic) // To be destroyed
+                    return destroy_tower_income(tower_num_of_player(player_id));
+                else // To be downgraded
+                    return downgrade_tower_income(t.value().type);
+            }
+            case UseLightningStorm:
+            case UseEmpBlaster:
+            case UseDeflector:
+            case UseEmergencyEvasion:
+                return -use_super_weapon_cost(op.type % 10);
+            case UpgradeGenerationSpeed:
+                return -upgrade_base_cost(bases[player_id].gen_speed_level);
+            case UpgradeGeneratedAnt:
+                return -upgrade_base_cost(bases[player_id].ant_level);
+            default:
+                return 0;
+        }
+    }
+    
+    bool check_affordable(int player_id, const std::vector<Operation>& ops) const
+    {
+        int income = 0, tower_num = tower_num_of_player(player_id);
+        for (const Operation& op : ops)
+        {
+            // Special handling for BuildTower and DowngradeTower, for the cost of
+            // BuildTower and DowngradeTower depends on the number of towers of the player.
+            switch (op.type)
+            {
+            case OperationType::BuildTower:
+                income -= build_tower_cost(tower_num++);
+                break;
+            case OperationType::DowngradeTower:
+            {
+                auto t = tower_of_id(op.arg0);
+                if (t.value().type == TowerType::Basic) // To be destroyed
+                    income += destroy_tower_income(tower_num--);
+                else // To be downgraded
+                    income += downgrade_tower_income(t.value().type);
+                break;
+            }
+            default:
+                income += get_operation_income(player_id, op);
+                break;
+            }
+        }
+        return income + coins[player_id] >= 0;
+    }
+
+    void apply_operation(int player_id, const Operation& op)
+    {
+        update_coin(player_id, get_operation_income(player_id, op));
+        switch (op.type)
+        {
+            case BuildTower:
+                build_tower(next_tower_id++, player_id, op.arg0, op.arg1);
+                break;
+            case UpgradeTower:
+                upgrade_tower(op.arg0, static_cast<TowerType>(op.arg1));
+                break;
+            case DowngradeTower:
+                downgrade_or_destroy_tower(op.arg0);
+                break;
+            case UseLightningStorm:
+            case UseEmpBlaster:
+            case UseDeflector:
+            case UseEmergencyEvasion:
+                use_super_weapon(static_cast<SuperWeaponType>(op.type % 10), player_id, op.arg0, op.arg1);
+                break;
+            case UpgradeGenerationSpeed:
+                upgrade_generation_speed(player_id);
+                break;
+            case UpgradeGeneratedAnt:
+                upgrade_generated_ant(player_id);
+                break;
+        }
+    }
+
+    int next_move(const Ant& ant) const
+    {
+        // Constants
+        static constexpr double ETA[] = {1.25, 1.00, 0.75};
+        static constexpr int ETA_OFFSET = 1;
+
+        // Data
+        int target_x = Base::POSITION[!ant.player][0],
+            target_y = Base::POSITION[!ant.player][1];
+        int cur_dist = distance(ant.x, ant.y, target_x, target_y);
+
+        // Store weighted and original pheromone
+        double phero[6][2] = {};
+        static constexpr int WEIGHTED = 0, ORIGINAL = 1;
+        std::fill(&phero[0][0], &phero[0][0] + sizeof(phero) / sizeof(double), -1.0); // Init
+
+        // Compute weighted and original pheromone
+        for (int i = 0; i < 6; ++i)
+        {
+            // Neighbor coordinates
+            int x = ant.x + OFFSET[ant.y % 2][i][0],
+                y = ant.y + OFFSET[ant.y % 2][i][1];
+            // Valid: not blocked and not going back
+            if ((!ant.path.empty() && ant.path.back() == (i + 3) % 6) || !is_path(x, y))
+                continue;
+            // Weight (Atrract)
+            int next_dist = distance(x, y, target_x, target_y);
+            double weight = ETA[next_dist - cur_dist + ETA_OFFSET];
+            // Update
+            phero[i][WEIGHTED] = weight * pheromone[ant.player][x][y];
+            phero[i][ORIGINAL] = pheromone[ant.player][x][y];
+        }
+
+        // Get max
+        auto p = std::max_element(phero, std::end(phero),
+            [phero] (const double ph1[], const double ph2[]) {
+                // Check weighted pheromone
+                if (ph1[WEIGHTED] != ph2[WEIGHTED])
+                    return ph1[WEIGHTED] < ph2[WEIGHTED];
+                // Then check original pheromone
+                if (ph1[ORIGINAL] != ph2[ORIGINAL])
+                    return ph1[ORIGINAL] < ph2[ORIGINAL];
+                // If all equals, take one with smaller index as the bigger
+                return std::distance(&phero[0][0], ph1) > std::distance(&phero[0][0], ph2);
+            });
+        
+        // Return direction
+        return std::distance(phero, p);
+    }
+    
+
+    static int destroy_tower_income(int tower_num)
+    {
+        return build_tower_cost(tower_num - 1) * TOWER_DOWNGRADE_REFUND_RATIO;
+    }
+
+    static int downgrade_tower_income(int type)
+    {
+        return upgrade_tower_cost(type) * TOWER_DOWNGRADE_REFUND_RATIO;
+    }
+
+    static int build_tower_cost(int tower_num)
+    {
+        return TOWER_BUILD_PRICE_BASE * std::pow(TOWER_BUILD_PRICE_RATIO, tower_num);
+    }
+
+    static int upgrade_tower_cost(int type)
+    {
+        switch (type)
+        {
+            // Level 2
+            case TowerType::Heavy:
+            case TowerType::Quick:
+            case TowerType::Mortar:
+                return LEVEL2_TOWER_UPGRADE_PRICE;
+            // Level 3
+            case TowerType::HeavyPlus:
+            case TowerType::Ice:
+            case TowerType::Cannon:
+            case TowerType::QuickPlus:
+            case TowerType::Double:
+            case TowerType::Sniper:
+            case TowerType::MortarPlus:
+            case TowerType::Pulse:
+            case TowerType::Missile:
+                return LEVEL3_TOWER_UPGRADE_PRICE;
+        }
+        return -1;
+    }
+
+    static int upgrade_base_cost(int level)
+    {
+        switch (level)
+        {
+            case 0: return LEVEL2_BASE_UPGRADE_PRICE;
+            case 1: return LEVEL3_BASE_UPGRADE_PRICE;
+        }
+        return -1;
+    }
+
+    static int use_super_weapon_cost(int type)
+    {
+        return SUPER_WEAPON_INFO[type][3];
+    }
+
+    void use_super_weapon(SuperWeaponType type, int player, int x, int y)
+    {
+        // Construct a super weapon
+        SuperWeapon sw(type, player, x, y);
+        // Apply EmergercyEvasion directly
+        if (sw.type == EmergencyEvasion)
+        {
+            for (Ant &ant : ants)
+            {
+                if (sw.is_in_range(ant.x, ant.y) && ant.player == sw.player)
+                    ant.evasion = 2;
+            }
+        }
+        // Add to super weapon list for other super weapons
+        else
+            super_weapons.emplace_back(std::move(sw));
+        // Reset cd
+        super_weapon_cd[player][type] = SUPER_WEAPON_INFO[type][2];
+    }
+
+    bool is_shielded_by_emp(int player_id, int x, int y) const
+    {
+        return std::any_of(super_weapons.begin(), super_weapons.end(), [player_id, x, y](const SuperWeapon& weapon){
+            return weapon.type == EmpBlaster && weapon.player != player_id && weapon.is_in_range(x, y);
+        });
+    }
+
+    bool is_shielded_by_emp(const Tower& tower) const
+    {
+        return is_shielded_by_emp(tower.player, tower.x, tower.y);
+    }
+
+    bool is_shielded_by_deflector(const Ant& a) const
+    {
+        return std::any_of(super_weapons.begin(), super_weapons.end(), [a](const SuperWeapon& weapon){
+            return weapon.type == Deflector && weapon.player == a.player && weapon.is_in_range(a.x, a.y);
+        });
+    }
+
+    void count_down_super_weapons_left_time(int player_id)
+    {
+        for (auto it = super_weapons.begin(); it != super_weapons.end(); )
+        {
+            if (it->player != player_id)
+            {
+                ++it;
+                continue;
+            }
+            // Count down
+            it->left_time--;
+            // Clear if timeout
+            if (it->left_time <= 0)
+                it = super_weapons.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    void count_down_super_weapons_cd()
+    {
+        for (int i = 0; i < 2; ++i)
+            for (int j = 1; j < 5; ++j)
+                super_weapon_cd[i][j] = std::max(super_weapon_cd[i][j] - 1, 0);
+    }
+
+};
+
+class Simulator
+{
+private:
+    GameInfo info;
+    std::vector<Operation> operations[2];
+
+    void attack_ants()
+    {
+
+        for (SuperWeapon& sw: info.super_weapons)
+        {
+            if(sw.type != SuperWeaponType::LightningStorm)
+                continue;
+            for (Ant &ant : info.ants)
+            {
+                if (sw.is_in_range(ant.x, ant.y) 
+                    && ant.player != sw.player)
+                {
+                    ant.hp = 0;
+                    ant.state = AntState::Fail;
+                    info.update_coin(sw.player, ant.reward());
+                }
+            }
+        }
+        
+        
+        // Set deflector property
+        for (Ant& ant: info.ants)
+            ant.deflector = info.is_shielded_by_deflector(ant);
+        // Attack
+        for (Tower& tower: info.towers)
+        {
+            // Skip if shielded by EMP
+            if (info.is_shielded_by_emp(tower))
+                continue;
+            // Try to attack
+            auto targets = tower.attack(info.ants);
+            // Get coins if tower killed the target
+            for (int idx: targets)
+            {
+                if (info.ants[idx].state == AntState::Fail)
+                    info.update_coin(tower.player, info.ants[idx].reward());
+            }
+            // Reset tower's damage (clear buff effect)
+            tower.damage = TOWER_INFO[tower.type].attack;
+        }
+        // Reset deflector property
+        for (Ant& ant: info.ants)
+            ant.deflector = false;
+    }
+
+    GameState move_ants()
+    {
+        for (Ant& ant: info.ants)
+        {
+            // Update age regardless of the state
+            ant.age++;
+            // 1) No other action for dead ants
+            if (ant.state == AntState::Fail)
+                continue;
+            // 2) Check if too old
+            if (ant.age > Ant::AGE_LIMIT)
+                ant.state = AntState::TooOld;
+            // 3) Move if possible (alive)
+            if (ant.state == AntState::Alive)
+                ant.move(info.next_move(ant));
+            // 4) Check if success (Mark success even if it reaches the age limit)
+            if (ant.x == Base::POSITION[!ant.player][0] && ant.y == Base::POSITION[!ant.player][1])
+            {
+                ant.state = AntState::Success;
+                info.update_base_hp(!ant.player, -1);
+                info.update_coin(ant.player, 5);
+                // If hp of one side's base reaches 0, game over 
+                if (info.bases[!ant.player].hp <= 0)
+                    return (ant.player == 0) ? GameState::Player0Win : GameState::Player1Win;
+            }
+            // 5) Unfreeze if frozen
+            if (ant.state == AntState::Frozen)
+                ant.state = AntState::Alive;
+        }
+        return GameState::Running;
+    }
+
+    void generate_ants()
+    {
+        for (auto& base: info.bases)
+        {
+            auto ant = base.generate_ant(info.next_ant_id, info.round);
+            if (ant)
+            {
+                info.ants.push_back(std::move(ant.value()));
+                info.next_ant_id++;
+            }
+        }
+    }
+
+    void get_basic_income(int player_id)
+    {
+        info.update_coin(player_id, BASIC_INCOME);
+    }
+
+    GameState judge_winner() const
+    {
+        if (info.bases[0].hp < info.bases[1].hp)
+            return GameState::Player1Win;
+        else if (info.bases[0].hp > info.bases[1].hp)
+            return GameState::Player0Win;
+        else
+            return GameState::Undecided;
+    }
+
+public:
+    Simulator(const GameInfo& info) : info(info) {}
+
+    const GameInfo& get_info()
+    {
+        return info;
+    }
+
+    const std::vector<Operation>& get_operations_of_player(int player_id) const
+    {
+        return operations[player_id];
+    }
+
+    bool add_operation_of_player(int player_id, Operation op)
+    {
+        if (info.is_operation_valid(player_id, operations[player_id], op))
+        {
+            operations[player_id].push_back(op);
+            return true;
+        }
+        return false;
+    }
+
+    void apply_operations_of_player(int player_id)
+    {
+        // 1) count down long-lasting weapons' left-time
+        info.count_down_super_weapons_left_time(player_id);
+        // 2) apply opponent's operations
+        for (auto& op: operations[player_id])
+            info.apply_operation(player_id, op);
+    }
+
+    GameState next_round()
+    {
+        // 1) Judge winner at MAX_ROUND
+        if (info.round == MAX_ROUND)
+            return judge_winner();
+        // 2) Towers attack ants
+        attack_ants();
+        // 3) Ants move
+        GameState state = move_ants();
+        if (state != GameState::Running)
+            return state;
+        // 4) Update pheromone
+        info.global_pheromone_attenuation();
+        info.update_pheromone_for_ants();
+        // 5) Clear dead and succeeded ants
+        info.clear_dead_and_succeeded_ants();
+        // 6) Barracks generate new ants
+        generate_ants();
+        // 7) Get basic income
+        get_basic_income(0);
+        get_basic_income(1);
+        // 8) Start next round
+        info.round++;
+        // 9) Count down super weapons' cd
+        info.count_down_super_weapons_cd();
+        // 10) Clear operations
+        operations[0].clear();
+        operations[1].clear();
+
+        return GameState::Running;
+    }
+};
+
+} // namespace reference
@@ -0,0 +1,288 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include "reference.hpp"
+
+// Differential fuzzing of Simulator against the frozen reference implementation.
+//
+// An input is a seed followed by a byte stream choosing operations of both players round by
+// round. Both engines play the same game and their full states are compared after every
+// operation and every round. Any difference aborts with a description.
+//
+// Build with "make fuzz" for the plain random driver (usage: simulator_fuzz [iterations] [seed]),
+// or with "make fuzz-libfuzzer" for a libFuzzer target.
+
+namespace
+{
+
+/**
+ * @brief Consumer of fuzzing input. Zeros are returned after the input is exhausted.
+ */
+struct Input
+{
+    const uint8_t* data;
+    size_t size;
+
+    uint8_t byte()
+    {
+        if (size == 0)
+            return 0;
+        --size;
+        return *data++;
+    }
+
+    uint64_t u64()
+    {
+        uint64_t x = 0;
+        for (int i = 0; i < 8; ++i)
+            x = x << 8 | byte();
+        return x;
+    }
+};
+
+/**
+ * @brief Collector of differences between two states.
+ */
+struct Diff
+{
+    std::ostringstream out;
+    bool found = false;
+
+    Diff()
+    {
+        out.precision(17);
+    }
+
+    template <typename T>
+    void check(const char* what, int index, const T& a, const T& b)
+    {
+        if (found || a == b)
+            return;
+        found = true;
+        out << what;
+        if (index >= 0)
+            out << '[' << index << ']';
+        out << ": " << a << " (engine) != " << b << " (reference)";
+    }
+};
+
+void compare(const GameInfo& a, const reference::GameInfo& b, Diff& diff)
+{
+    diff.check("round", -1, a.round, b.round);
+    diff.check("next_ant_id", -1, a.next_ant_id, b.next_ant_id);
+    diff.check("next_tower_id", -1, a.next_tower_id, b.next_tower_id);
+    for (int i = 0; i < 2; ++i)
+    {
+        diff.check("coins", i, a.coins[i], b.coins[i]);
+        diff.check("bases.hp", i, a.bases[i].hp, b.bases[i].hp);
+        diff.check("bases.gen_speed_level", i, a.bases[i].gen_speed_level, b.bases[i].gen_speed_level);
+        diff.check("bases.ant_level", i, a.bases[i].ant_level, b.bases[i].ant_level);
+        for (int j = 0; j < SuperWeaponCount; ++j)
+            diff.check("super_weapon_cd", i * SuperWeaponCount + j, a.super_weapon_cd[i][j], b.super_weapon_cd[i][j]);
+        for (int x = 0; x < MAP_SIZE; ++x)
+            for (int y = 0; y < MAP_SIZE; ++y)
+                diff.check("pheromone", (i * MAP_SIZE + x) * MAP_SIZE + y, a.pheromone[i][x][y], b.pheromone[i][x][y]);
+    }
+    diff.check("towers.size", -1, a.towers.size(), b.towers.size());
+    for (size_t i = 0; i < a.towers.size() && i < b.towers.size(); ++i)
+    {
+        const Tower& t = a.towers[i];
+        const reference::Tower& u = b.towers[i];
+        diff.check("towers.id", i, t.id, u.id);
+        diff.check("towers.player", i, t.player, u.player);
+        diff.check("towers.x", i, t.x, u.x);
+        diff.check("towers.y", i, t.y, u.y);
+        diff.check("towers.type", i, t.type, u.type);
+        diff.check("towers.damage", i, t.damage, u.damage);
+        diff.check("towers.range", i, t.range, u.range);
+        diff.check("towers.cd", i, t.cd, u.cd);
+        diff.check("towers.speed", i, t.speed, u.speed);
+    }
+    diff.check("ants.size", -1, a.ants.size(), b.ants.size());
+    for (size_t i = 0; i < a.ants.size() && i < b.ants.size(); ++i)
+    {
+        const Ant& t = a.ants[i];
+        const reference::Ant& u = b.ants[i];
+        diff.check("ants.id", i, t.id, u.id);
+        diff.check("ants.player", i, t.player, u.player);
+        diff.check("ants.x", i, t.x, u.x);
+        diff.check("ants.y", i, t.y, u.y);
+        diff.check("ants.hp", i, t.hp, u.hp);
+        diff.check("ants.level", i, t.level, u.level);
+        diff.check("ants.age", i, t.age, u.age);
+        diff.check("ants.state", i, t.state, u.state);
+        diff.check("ants.evasion", i, t.evasion, u.evasion);
+        diff.check("ants.deflector", i, t.deflector, u.deflector);
+        diff.check("ants.path", i, t.path == u.path, true);
+    }
+    diff.check("super_weapons.size", -1, a.super_weapons.size(), b.super_weapons.size());
+    for (size_t i = 0; i < a.super_weapons.size() && i < b.super_weapons.size(); ++i)
+    {
+        const SuperWeapon& t = a.super_weapons[i];
+        const reference::SuperWeapon& u = b.super_weapons[i];
+        diff.check("super_weapons.type", i, t.type, u.type);
+        diff.check("super_weapons.player", i, t.player, u.player);
+        diff.check("super_weapons.x", i, t.x, u.x);
+        diff.check("super_weapons.y", i, t.y, u.y);
+        diff.check("super_weapons.left_time", i, t.left_time, u.left_time);
+        diff.check("super_weapons.range", i, t.range, u.range);
+    }
+}
+
+[[noreturn]] void fail(const std::string& where, const std::string& what)
+{
+    std::fprintf(stderr, "MISMATCH %s: %s\n", where.c_str(), what.c_str());
+    std::abort();
+}
+
+void expect_same(Simulator& engine, reference::Simulator& ref, const char* where)
+{
+    Diff diff;
+    compare(engine.get_info(), ref.get_info(), diff);
+    if (diff.found)
+        fail(std::string(where) + " at round " + std::to_string(ref.get_info().round), diff.out.str());
+}
+
+/**
+ * @brief Choose an operation of a player from input. Most operations are built from the
+ * current state so that a fair share of them is legal.
+ */
+Operation choose_operation(const GameInfo& info, int player, Input& in)
+{
+    uint8_t kind = in.byte() % 8, a = in.byte(), b = in.byte();
+    std::vector<const Tower*> own;
+    for (const Tower& tower: info.towers)
+        if (tower.player == player)
+            own.push_back(&tower);
+    switch (kind)
+    {
+        case 0: // Build on an arbitrary cell, mostly illegal
+            return Operation(BuildTower, a % MAP_SIZE, b % MAP_SIZE);
+        case 1: // Build near own side
+        {
+            int x = player == 0 ? a % 10 : MAP_SIZE - 1 - a % 10;
+            return Operation(BuildTower, x, b % MAP_SIZE);
+        }
+        case 2: // Upgrade own tower
+        {
+            if (own.empty())
+                return Operation(UpgradeTower, a, b % 40);
+            const Tower& tower = *own[a % own.size()];
+            int target = tower.type == TowerType::Basic ? 1 + b % 3 : tower.type * 10 + 1 + b % 3;
+            return Operation(UpgradeTower, tower.id, b % 16 == 0 ? b % 40 : target);
+        }
+        case 3: // Downgrade own or any tower
+            if (own.empty() || b % 8 == 0)
+                return Operation(DowngradeTower, a % (info.next_tower_id + 1));
+            return Operation(DowngradeTower, own[a % own.size()]->id);
+        case 4: // Super weapon around an ant
+        case 5:
+        {
+            OperationType type = static_cast<OperationType>(UseLightningStorm + b % 4);
+            if (info.ants.empty())
+                return Operation(type, a % MAP_SIZE, b % MAP_SIZE);
+            const Ant& ant = info.ants[a % info.ants.size()];
+            return Operation(type, ant.x, ant.y);
+        }
+        case 6:
+            return Operation(b % 2 ? UpgradeGenerationSpeed : UpgradeGeneratedAnt);
+        default: // Anything, mostly illegal
+            return Operation(static_cast<OperationType>(a % 40), b % MAP_SIZE, a % MAP_SIZE);
+    }
+}
+
+/**
+ * @brief Play one player's turn in both engines.
+ */
+void play_turn(Simulator& engine, reference::Simulator& ref, int player, Input& in, bool observe)
+{
+    if (!observe)
+    {
+        engine.apply_operations_of_player(player);
+        ref.apply_operations_of_player(player);
+        return;
+    }
+    int attempts = in.byte() % 5;
+    for (int i = 0; i < attempts; ++i)
+    {
+        Operation op = choose_operation(engine.get_info(), player, in);
+        bool added = engine.add_operation_of_player(player, op);
+        if (added != ref.add_operation_of_player(player, op))
+        {
+            std::ostringstream out;
+            out << "player " << player << " operation " << op.type << ' ' << op.arg0 << ' ' << op.arg1
+                << (added ? " accepted by engine only" : " accepted by reference only");
+            fail("add_operation_of_player at round " + std::to_string(ref.get_info().round), out.str());
+        }
+    }
+    engine.apply_operations_of_player(player);
+    ref.apply_operations_of_player(player);
+    expect_same(engine, ref, "apply_operations_of_player");
+}
+
+/**
+ * @brief Play a whole game in both engines, as driven by the input.
+ */
+void run(Input in)
+{
+    unsigned long long seed = in.u64();
+    Simulator engine{GameInfo(seed)};
+    reference::Simulator ref{reference::GameInfo(seed)};
+    expect_same(engine, ref, "construction");
+    while (true)
+    {
+        // Some rounds are played without looking at the engine, so that state it only brings up
+        // to date when observed (e.g. tower cds) is left behind over several rounds, or copied
+        uint8_t mode = in.byte() % 8;
+        bool observe = mode >= 2;
+        if (mode == 1)
+        {
+            Simulator copy(engine);
+            engine.assign(copy);
+        }
+        play_turn(engine, ref, 0, in, observe);
+        play_turn(engine, ref, 1, in, observe);
+        GameState state = engine.next_round();
+        if (state != ref.next_round())
+            fail("next_round at round " + std::to_string(ref.get_info().round), "different game states");
+        if (observe || state != GameState::Running)
+            expect_same(engine, ref, "next_round");
+        if (state != GameState::Running)
+            break;
+    }
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    run(Input{data, size});
+    return 0;
+}
+
+#ifndef ANTWAR_LIBFUZZER
+
+// Plain random driver: feed random inputs of random lengths.
+int main(int argc, char* argv[])
+{
+    long iterations = argc > 1 ? std::atol(argv[1]) : 200;
+    unsigned long seed = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1;
+    std::mt19937_64 random(seed);
+    std::vector<uint8_t> data;
+    for (long i = 0; i < iterations; ++i)
+    {
+        // Long enough inputs keep operations coming until the game ends
+        data.resize(8 + random() % 8192);
+        for (auto& byte: data)
+            byte = static_cast<uint8_t>(random());
+        LLVMFuzzerTestOneInput(data.data(), data.size());
+    }
+    std::printf("%ld games passed\n", iterations);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,277 @@
+/**
+ * @file async_io.hpp
+ * @author Yufei Li, Jingxuan Liu
+ * @brief Reading messages from judger on a background thread.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "io.hpp"
+
+/**
+ * @brief A lock-free single-producer/single-consumer queue of fixed capacity.
+ * @tparam T Type of elements, which must be default constructible and movable.
+ * @tparam N Capacity, which must be a power of 2.
+ */
+template <typename T, std::size_t N>
+class SpscQueue
+{
+    static_assert(N && (N & (N - 1)) == 0, "capacity must be a power of 2");
+
+private:
+    T slots[N];
+    alignas(64) std::atomic<std::size_t> head; ///< Index of the next element to pop, owned by the consumer
+    alignas(64) std::atomic<std::size_t> tail; ///< Index of the next element to push, owned by the producer
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+
+    /**
+     * @brief Try to push an element. Called by the producer only.
+     * @param value The element, which is moved away on success.
+     * @return Whether the element is pushed, i.e. the queue is not full.
+     */
+    bool try_push(T& value)
+    {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N)
+            return false;
+        slots[t & (N - 1)] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Try to pop an element. Called by the consumer only.
+     * @param value Reference to the result.
+     * @return Whether an element is popped, i.e. the queue is not empty.
+     */
+    bool try_pop(T& value)
+    {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+        value = std::move(slots[h & (N - 1)]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Check if there is nothing to pop. Called by the consumer only.
+     */
+    bool empty() const
+    {
+        return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire);
+    }
+};
+
+/**
+ * @brief A message received from judger after initialization.
+ */
+struct JudgerMessage
+{
+    enum Kind
+    {
+        OpponentOperations, ///< Opponent's operations, see read_opponent_operations()
+        Round               ///< Round information, see read_round_info()
+    };
+
+    Kind kind;
+    std::vector<Operation> operations; ///< Valid if kind is OpponentOperations
+    RoundInfo round_info;              ///< Valid if kind is Round
+};
+
+/**
+ * @brief Reader of judger messages on a background IO thread, so that the decision loop never
+ * blocks on input and can keep computing until data is ready.
+ *
+ * After initialization judger always sends opponent's operations and round information in turn,
+ * whichever player you are. The IO thread parses them as soon as they arrive and queues them.
+ *
+ * @code
+ * Controller c;             // Reads initialization information as usual
+ * AsyncReader reader;       // Start reading in background
+ * ...
+ * RoundInfo info;
+ * while (!reader.try_read_round_info(info))
+ *     think_a_bit_more();
+ * c.update_round_info(info);
+ * @endcode
+ *
+ * @note Construct it after the Controller, which reads initialization information synchronously.
+ * Do not read from the same stream elsewhere afterwards.
+ */
+class AsyncReader
+{
+private:
+    /**
+     * @brief State shared with the IO thread, which may outlive the reader while blocked on input.
+     */
+    struct Shared
+    {
+        SpscQueue<JudgerMessage, 64> queue;
+        std::atomic<bool> closed; ///< Whether the input has ended
+        std::atomic<bool> stopped; ///< Whether the reader has been destroyed
+
+        Shared() : closed(false), stopped(false) {}
+    };
+
+    std::shared_ptr<Shared> shared;
+    JudgerMessage front; ///< The next message, popped ahead by ready()
+    bool has_front;
+
+    static void run(std::shared_ptr<Shared> shared, std::istream* in)
+    {
+        JudgerMessage message;
+        message.kind = JudgerMessage::OpponentOperations;
+        while (!shared->stopped)
+        {
+            if (message.kind == JudgerMessage::OpponentOperations)
+                message.operations = ::read_opponent_operations(*in);
+            else
+                message.round_info = ::read_round_info(*in);
+            if (!*in)
+                break;
+            JudgerMessage::Kind next = message.kind == JudgerMessage::OpponentOperations
+                ? JudgerMessage::Round : JudgerMessage::OpponentOperations;
+            while (!shared->queue.try_push(message))
+            {
+                if (shared->stopped)
+                    return;
+                std::this_thread::yield();
+            }
+            message.kind = next;
+        }
+        shared->closed = true;
+    }
+
+    /**
+     * @brief Get the next message of given kind without blocking.
+     */
+    bool try_take(JudgerMessage::Kind kind, JudgerMessage& message)
+    {
+        if (!ready())
+            return false;
+        if (front.kind != kind)
+            throw std::logic_error("unexpected judger message");
+        message = std::move(front);
+        has_front = false;
+        return true;
+    }
+
+    /**
+     * @brief Get the next message of given kind, waiting for it if necessary.
+     */
+    void take(JudgerMessage::Kind kind, JudgerMessage& message)
+    {
+        while (!try_take(kind, message))
+        {
+            if (closed())
+                throw std::runtime_error("input from judger has ended");
+            std::this_thread::yield();
+        }
+    }
+
+public:
+    /**
+     * @brief Start reading messages in background.
+     * @param in (Optional) The stream to read from, with std::cin as default.
+     */
+    explicit AsyncReader(std::istream& in = std::cin)
+        : shared(std::make_shared<Shared>()), has_front(false)
+    {
+        // A tied stream flushes std::cout before every read, which must not happen on the IO thread
+        in.tie(nullptr);
+        std::thread(run, shared, &in).detach();
+    }
+
+    ~AsyncReader()
+    {
+        shared->stopped = true;
+    }
+
+    AsyncReader(const AsyncReader&) = delete;
+    AsyncReader& operator=(const AsyncReader&) = delete;
+
+    /**
+     * @brief Check if the next message has arrived, without blocking.
+     */
+    bool ready()
+    {
+        if (!has_front)
+            has_front = shared->queue.try_pop(front);
+        return has_front;
+    }
+
+    /**
+     * @brief Check if the input has ended and every message has been taken.
+     */
+    bool closed()
+    {
+        return !ready() && shared->closed;
+    }
+
+    /**
+     * @brief Take opponent's operations if they have arrived, without blocking.
+     * @param ops Reference to the result.
+     * @return Whether the operations have arrived.
+     * @throw std::logic_error if round information is expected instead.
+     */
+    bool try_read_opponent_operations(std::vector<Operation>& ops)
+    {
+        JudgerMessage message;
+        if (!try_take(JudgerMessage::OpponentOperations, message))
+            return false;
+        ops = std::move(message.operations);
+        return true;
+    }
+
+    /**
+     * @brief Take round information if it has arrived, without blocking.
+     * @param info Reference to the result.
+     * @return Whether the information has arrived.
+     * @throw std::logic_error if opponent's operations are expected instead.
+     */
+    bool try_read_round_info(RoundInfo& info)
+    {
+        JudgerMessage message;
+        if (!try_take(JudgerMessage::Round, message))
+            return false;
+        info = std::move(message.round_info);
+        return true;
+    }
+
+    /**
+     * @brief Take opponent's operations, waiting for them if necessary.
+     * @throw std::runtime_error if the input ends before.
+     */
+    std::vector<Operation> read_opponent_operations()
+    {
+        JudgerMessage message;
+        take(JudgerMessage::OpponentOperations, message);
+        return std::move(message.operations);
+    }
+
+    /**
+     * @brief Take round information, waiting for it if necessary.
+     * @throw std::runtime_error if the input ends before.
+     */
+    RoundInfo read_round_info()
+    {
+        JudgerMessage message;
+        take(JudgerMessage::Round, message);
+        return std::move(message.round_info);
+    }
+};
@@ -622,8 +622,13 @@ struct Base
     static constexpr int GENERATION_CYCLE_INFO[] = {4, 2, 1}; ///< Ants will be generated when round index can be divided by this value
     
     Base(int player)
-        : player(player), x(POSITION[player][0]), y(POSITION[player][1]), hp(MAX_HP),
-          gen_speed_level(0), ant_level(0) {}
+        : Base(player, POSITION[player][0], POSITION[player][1]) {}
+
+    /**
+     * @brief Construct a base at a given position, e.g. on another map.
+     */
+    Base(int player, int x, int y)
+        : player(player), x(x), y(y), hp(MAX_HP), gen_speed_level(0), ant_level(0) {}
 
     /**
      * @brief Try to generate a new ant.
@@ -662,6 +667,108 @@ struct Base
 constexpr int Base::POSITION[2][2];
 constexpr int Base::GENERATION_CYCLE_INFO[];
 
+/* Maps */
+
+/**
+ * @brief Descriptor of the default map, on which BasicGameInfo and BasicSimulator are
+ * instantiated as GameInfo and Simulator. It forwards to the global constants and functions,
+ * so the default engine compiles to the same code as before it was map-generic.
+ *
+ * A map descriptor is a type with:
+ * - "static constexpr int SIZE", the size of the map in both coordinates;
+ * - "static bool is_valid_pos(int x, int y)", "static bool is_path(int x, int y)" and
+ *   "static bool is_highland(int player, int x, int y)", as the global functions;
+ * - "static constexpr int base_x(int player)" and "static constexpr int base_y(int player)".
+ *
+ * Coordinates are on the same hexagonal grid on any map, so distance() and OFFSET are shared.
+ */
+struct DefaultMap
+{
+    static constexpr int SIZE = MAP_SIZE;
+
+    static bool is_valid_pos(int x, int y)
+    {
+        return ::is_valid_pos(x, y);
+    }
+
+    static bool is_path(int x, int y)
+    {
+        return ::is_path(x, y);
+    }
+
+    static bool is_highland(int player, int x, int y)
+    {
+        return ::is_highland(player, x, y);
+    }
+
+    static constexpr int base_x(int player)
+    {
+        return Base::POSITION[player][0];
+    }
+
+    static constexpr int base_y(int player)
+    {
+        return Base::POSITION[player][1];
+    }
+};
+
+constexpr int DefaultMap::SIZE;
+
+/**
+ * @brief Map descriptor built from a layout, for maps other than the default one.
+ *
+ * A layout is a type with "static constexpr int SIZE", "static constexpr int PROPERTY[SIZE][SIZE]"
+ * of PointType values, and "static constexpr int BASE_POSITION[2][2]". As in C++11, the arrays
+ * also need definitions outside the class.
+ *
+ * @code
+ * struct SmallLayout
+ * {
+ *     static constexpr int SIZE = 11;
+ *     static constexpr int PROPERTY[SIZE][SIZE] = {...};
+ *     static constexpr int BASE_POSITION[2][2] = {{2, 5}, {8, 5}};
+ * };
+ * constexpr int SmallLayout::PROPERTY[SmallLayout::SIZE][SmallLayout::SIZE];
+ * constexpr int SmallLayout::BASE_POSITION[2][2];
+ *
+ * BasicSimulator<MapDescriptor<SmallLayout>> s(BasicGameInfo<MapDescriptor<SmallLayout>>(seed));
+ * @endcode
+ */
+template <typename Layout>
+struct MapDescriptor
+{
+    static constexpr int SIZE = Layout::SIZE;
+
+    static bool is_valid_pos(int x, int y)
+    {
+        return x >= 0 && x < SIZE && y >= 0 && y < SIZE && Layout::PROPERTY[x][y] != PointType::Void;
+    }
+
+    static bool is_path(int x, int y)
+    {
+        return x >= 0 && x < SIZE && y >= 0 && y < SIZE && Layout::PROPERTY[x][y] == PointType::Path;
+    }
+
+    static bool is_highland(int player, int x, int y)
+    {
+        return x >= 0 && x < SIZE && y >= 0 && y < SIZE
+            && Layout::PROPERTY[x][y] == (player == 0 ? PointType::Player0Highland : PointType::Player1Highland);
+    }
+
+    static constexpr int base_x(int player)
+    {
+        return Layout::BASE_POSITION[player][0];
+    }
+
+    static constexpr int base_y(int player)
+    {
+        return Layout::BASE_POSITION[player][1];
+    }
+};
+
+template <typename Layout>
+constexpr int MapDescriptor<Layout>::SIZE;
+
 /**
  * @brief Tag for the type of a super weapon. The integer values of these enumeration items
  * are also their indexes.
@@ -13,6 +13,7 @@
 #include <vector>
 #include "game_info.hpp"
 #include "io.hpp"
+#include "trace.hpp"
 
 /**
  * @brief An integrated module of IO and game state management with simple interfaces
@@ -98,15 +99,16 @@ private:
         info.set_base_hp(1, hp1);
     }
 
+public:
+    const int self_player_id; ///< Your player ID
+
     /**
-     * @brief Construct a new Controller object with given init info.
+     * @brief Construct a new Controller object with init info received elsewhere, e.g. by a bot
+     *        host serving many games (see host_with_ai()).
      */
-    Controller(InitInfo init_info)
+    explicit Controller(InitInfo init_info)
         : info(init_info.second), self_player_id(init_info.first) {}
 
-public:
-    const int self_player_id; ///< Your player ID
-
     /**
      * @brief Construct a new Controller object. Read initializing information from
      *        judger and initialize.
@@ -145,20 +147,36 @@ public:
      */
     void read_round_info()
     {
+        ANTWAR_TRACE_SCOPE("read_round_info");
         // 1. Read
-        auto result = ::read_round_info();
+        RoundInfo result;
+        {
+            ANTWAR_TRACE_SCOPE("io.read_round_info");
+            result = ::read_round_info();
+        }
         // 2. Update
+        update_round_info(result);
+    }
+
+    /**
+     * @brief Update current game state with round information received elsewhere, e.g. from
+     *        an AsyncReader. This is what read_round_info() does after reading.
+     * @param result Round information from judger. Its towers are moved away.
+     */
+    void update_round_info(RoundInfo& result)
+    {
+        ANTWAR_TRACE_SCOPE("sync.round_info");
+        // 1. Update
         // 1) Towers
         update_towers(result.towers);
         // 2) Ants and Pheromone
         update_ants(result.ants);
-        info.global_pheromone_attenuation();
-        info.update_pheromone_for_ants();
+        info.update_pheromone_for_round();
         info.clear_dead_and_succeeded_ants();
         // 3) Coins and Bases
         update_coins(result.coin0, result.coin1);
         update_bases_hp(result.hp0, result.hp1);
-        // 3. Start Next Round
+        // 2. Start Next Round
         // 1) update round number
         info.round = result.round;
         // 2) count down super weapons' cd
@@ -173,14 +191,25 @@ public:
      */
     void read_opponent_operations()
     {
+        ANTWAR_TRACE_SCOPE("io.read_opponent_operations");
         opponent_operations = ::read_opponent_operations();
     }
 
+    /**
+     * @brief Overwrite "opponent_operations" with operations received elsewhere, e.g. from an AsyncReader.
+     * @param ops Opponent's operations from judger.
+     */
+    void set_opponent_operations(std::vector<Operation> ops)
+    {
+        opponent_operations = std::move(ops);
+    }
+
     /**
      * @brief Apply all the operations in "opponent_operations" to current game state. 
      */
     void apply_opponent_operations()
     {
+        ANTWAR_TRACE_SCOPE("apply_opponent_operations");
         // 1) count down opponent's super weapons' left-time
         info.count_down_super_weapons_left_time(!self_player_id);
         // 2) apply opponent's operations
@@ -222,6 +251,7 @@ public:
      */
     void apply_self_operations()
     {
+        ANTWAR_TRACE_SCOPE("apply_self_operations");
         // 1) count down self's long-lasting weapons' left-time
         info.count_down_super_weapons_left_time(self_player_id);
         // 2) apply self operations
@@ -234,6 +264,7 @@ public:
      */ 
     void send_self_operations() const
     {
+        ANTWAR_TRACE_SCOPE("send_self_operations");
         send_operations(self_operations);        
     }
 };
\ No newline at end of file
@@ -0,0 +1,378 @@
+/**
+ * @file coroutine.hpp
+ * @author Yufei Li, Jingxuan Liu
+ * @brief Coroutine-based bot runtime for C++20 builds.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * @note Everything here is available only when the compiler supports C++20 coroutines
+ * (e.g. "g++ -std=c++20"). The header is empty otherwise.
+ */
+
+#pragma once
+
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "control.hpp"
+#include "async_io.hpp"
+
+class BotContext;
+
+/**
+ * @brief Return type of a bot coroutine, which owns the coroutine.
+ *
+ * A bot is a coroutine taking a BotContext&. Inside it,
+ * - "co_await context.next_turn()" suspends until it is time to decide, and gives current game state;
+ * - "co_yield ops" publishes the best decision so far, and tells whether to keep improving it;
+ * - "co_await context.pause()" lets the runtime do its work, and tells whether to keep going.
+ */
+class BotTask
+{
+public:
+    struct promise_type;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+private:
+    handle_type handle;
+
+    friend class BotContext;
+
+public:
+    /**
+     * @brief Awaiter of a cooperative suspension point, resuming with whether current work is
+     * still worth continuing.
+     */
+    struct PauseAwaiter
+    {
+        BotContext& context;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<>) noexcept;
+        bool await_resume() const noexcept;
+    };
+
+    struct promise_type
+    {
+        BotContext* context = nullptr; ///< Set by the runtime before the coroutine first runs
+        std::exception_ptr exception;
+
+        BotTask get_return_object()
+        {
+            return BotTask(handle_type::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { exception = std::current_exception(); }
+
+        /**
+         * @brief Publish a (partial) decision, see BotContext::publish().
+         */
+        PauseAwaiter yield_value(std::vector<Operation> ops);
+    };
+
+    explicit BotTask(handle_type handle) : handle(handle) {}
+
+    BotTask(BotTask&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+    BotTask& operator=(BotTask&& other) noexcept
+    {
+        std::swap(handle, other.handle);
+        return *this;
+    }
+
+    ~BotTask()
+    {
+        if (handle)
+            handle.destroy();
+    }
+};
+
+/**
+ * @brief Bot coroutine, taking the context of the game it plays.
+ */
+using CoroutineAI = std::function<BotTask(BotContext&)>;
+
+/**
+ * @brief Interface between a bot coroutine and the runtime, which owns the game state and talks
+ * to judger.
+ *
+ * The runtime is single-threaded apart from the IO thread of AsyncReader. Whenever the bot
+ * suspends, the runtime polls for judger messages and resumes the bot as soon as possible, so a
+ * bot pausing regularly can keep searching while waiting for the opponent ("pondering").
+ *
+ * @code
+ * BotTask bot(BotContext& context)
+ * {
+ *     while (true)
+ *     {
+ *         const GameInfo& info = co_await context.next_turn();
+ *         Search search(info, context.player());
+ *         do
+ *             search.iterate();
+ *         while (co_yield search.best());
+ *     }
+ * }
+ *
+ * int main()
+ * {
+ *     run_with_coroutine(bot);
+ * }
+ * @endcode
+ */
+class BotContext
+{
+private:
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Where the bot is suspended.
+     */
+    enum class Suspension
+    {
+        None,  ///< Not started, running or finished
+        Turn,  ///< In next_turn(), i.e. done with the previous decision
+        Pause  ///< In pause() or co_yield, i.e. in the middle of some work
+    };
+
+    Controller& controller;
+    BotTask task;
+    Suspension suspension = Suspension::None;
+    std::vector<Operation> decision; ///< Latest published decision
+    bool deciding = false;           ///< Whether it is time to decide
+    bool changed = false;            ///< Whether game state has changed since the bot last ran
+    bool keep_going = true;          ///< Result of the pending pause()
+    clock::time_point deadline;      ///< Deadline of current decision
+    std::chrono::milliseconds budget;
+
+    friend struct BotTask::PauseAwaiter;
+    friend BotTask::PauseAwaiter BotTask::promise_type::yield_value(std::vector<Operation>);
+
+    /**
+     * @brief Resume the bot until it suspends again.
+     * @throw Whatever the bot throws.
+     */
+    void step()
+    {
+        BotTask::handle_type handle = task.handle;
+        if (!handle || handle.done())
+        {
+            suspension = Suspension::None;
+            return;
+        }
+        keep_going = !changed && (!deciding || clock::now() < deadline);
+        changed = false;
+        suspension = Suspension::None;
+        handle.resume();
+        if (handle.promise().exception)
+            std::rethrow_exception(handle.promise().exception);
+    }
+
+    /**
+     * @brief Wait for a judger message, letting a pausing bot work in the meantime.
+     * @param try_read Callback trying to take the message, returning whether it has arrived.
+     * @return Whether the message has arrived, i.e. false if the game has ended.
+     */
+    template <typename F>
+    bool wait(AsyncReader& reader, F try_read)
+    {
+        while (!try_read())
+        {
+            if (reader.closed())
+                return false;
+            if (suspension == Suspension::Pause)
+                step();
+            else
+                std::this_thread::yield();
+        }
+        changed = true;
+        return true;
+    }
+
+    /**
+     * @brief Let the bot decide until it is done or out of time, then send its decision.
+     */
+    void decide()
+    {
+        ANTWAR_TRACE_SCOPE("ai");
+        clock::time_point end = clock::now() + budget;
+        // Interrupt pondering, after which the bot should come back for next turn. Every pause
+        // returns false meanwhile, and nothing it yields is published.
+        while (suspension == Suspension::Pause && clock::now() < end)
+        {
+            changed = true;
+            step();
+        }
+        deciding = true;
+        deadline = end;
+        decision.clear();
+        if (suspension == Suspension::Turn)
+            step();
+        while (suspension == Suspension::Pause && clock::now() < deadline)
+            step();
+        deciding = false;
+        changed = true;
+        for (auto& op: decision)
+            controller.append_self_operation(op);
+        controller.send_self_operations();
+        controller.apply_self_operations();
+    }
+
+public:
+    /**
+     * @brief Awaiter of next_turn().
+     */
+    struct TurnAwaiter
+    {
+        BotContext& context;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<>) noexcept { context.suspension = Suspension::Turn; }
+        const GameInfo& await_resume() const noexcept { return context.info(); }
+    };
+
+    /**
+     * @brief Start a bot coroutine on a game.
+     * @param controller Controller of the game, which must outlive the context.
+     * @param ai The bot coroutine.
+     * @param budget Time for each decision.
+     */
+    BotContext(Controller& controller, const CoroutineAI& ai, std::chrono::milliseconds budget)
+        : controller(controller), task(ai(*this)), budget(budget)
+    {
+        task.handle.promise().context = this;
+        // Run until the bot first waits for its turn
+        step();
+    }
+
+    BotContext(const BotContext&) = delete;
+    BotContext& operator=(const BotContext&) = delete;
+
+    /**
+     * @brief Get current game state, which is updated in place whenever the bot is suspended.
+     */
+    const GameInfo& info() const
+    {
+        return controller.get_info();
+    }
+
+    /**
+     * @brief Get the player id of the bot.
+     */
+    int player() const
+    {
+        return controller.self_player_id;
+    }
+
+    /**
+     * @brief Get the time left for current decision, or zero if it is not time to decide.
+     */
+    std::chrono::milliseconds time_left() const
+    {
+        if (!deciding)
+            return std::chrono::milliseconds(0);
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - clock::now());
+        return left.count() > 0 ? left : std::chrono::milliseconds(0);
+    }
+
+    /**
+     * @brief Wait until it is time to decide. Co_awaiting it means the previous decision is final.
+     * @return Current game state, see info().
+     */
+    TurnAwaiter next_turn()
+    {
+        return TurnAwaiter{*this};
+    }
+
+    /**
+     * @brief Suspend to let the runtime handle judger messages.
+     * @return Whether current work is still worth continuing, i.e. false if the game state has
+     *         changed since the bot last ran, or the decision deadline has passed.
+     */
+    BotTask::PauseAwaiter pause()
+    {
+        return BotTask::PauseAwaiter{*this};
+    }
+
+    /**
+     * @brief Replace the decision to be sent. Operations that turn out to be invalid are ignored.
+     * @param ops The decision.
+     */
+    void publish(std::vector<Operation> ops)
+    {
+        if (deciding)
+            decision = std::move(ops);
+    }
+
+    friend void run_with_coroutine(const CoroutineAI& ai, std::chrono::milliseconds budget);
+};
+
+inline void BotTask::PauseAwaiter::await_suspend(std::coroutine_handle<>) noexcept
+{
+    context.suspension = BotContext::Suspension::Pause;
+}
+
+inline bool BotTask::PauseAwaiter::await_resume() const noexcept
+{
+    return context.keep_going;
+}
+
+inline BotTask::PauseAwaiter BotTask::promise_type::yield_value(std::vector<Operation> ops)
+{
+    context->publish(std::move(ops));
+    return PauseAwaiter{*context};
+}
+
+/**
+ * @brief Run the game with a bot coroutine. Both players follow the same control flow, except that
+ * player 1 receives opponent's operations before deciding and player 0 after.
+ * @param ai The bot coroutine.
+ * @param budget (Optional) Time for each decision. The best decision published by then is sent.
+ */
+inline void run_with_coroutine(const CoroutineAI& ai, std::chrono::milliseconds budget = std::chrono::milliseconds(500))
+{
+    Controller c;
+    AsyncReader reader;
+    BotContext context(c, ai, budget);
+
+    auto receive_opponent_operations = [&]
+    {
+        std::vector<Operation> ops;
+        if (!context.wait(reader, [&] { return reader.try_read_opponent_operations(ops); }))
+            return false;
+        c.set_opponent_operations(std::move(ops));
+        c.apply_opponent_operations();
+        return true;
+    };
+    auto receive_round_info = [&]
+    {
+        RoundInfo info;
+        if (!context.wait(reader, [&] { return reader.try_read_round_info(info); }))
+            return false;
+        c.update_round_info(info);
+        return true;
+    };
+
+    while (true)
+    {
+        ANTWAR_TRACE_SCOPE("round");
+        if (c.self_player_id == 1 && !receive_opponent_operations())
+            return;
+        context.decide();
+        if (c.self_player_id == 0 && !receive_opponent_operations())
+            return;
+        if (!receive_round_info())
+            return;
+    }
+}
+
+#endif
@@ -0,0 +1,369 @@
+/**
+ * @file endgame.hpp
+ * @author Yufei Li, Jingxuan Liu
+ * @brief Alpha-beta solver for the last rounds of a game.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "simulate.hpp"
+
+/**
+ * @brief Result of a game from the view of a player, with both sides restricted to their candidate
+ * moves (see EndgameSolver). Only a few single operations are candidates, so this is not a proof
+ * over all legal moves: an opponent move outside the candidates may still refute a CandidateWin.
+ */
+enum class EndgameOutcome
+{
+    CandidateWin,  ///< A win against every candidate move of the opponent
+    CandidateLoss, ///< A loss whatever candidate move the player makes
+    CandidateDraw, ///< Equal base hp at MAX_ROUND with best candidate play from both sides
+    Unresolved     ///< Nothing resolved within the horizon or the node limit
+};
+
+/**
+ * @brief Result of EndgameSolver::solve().
+ */
+struct EndgameResult
+{
+    EndgameOutcome outcome;
+    std::vector<Operation> operations; ///< Best operations found for the player to move
+    int score;                         ///< Minimax score from the view of the player to move
+    long long nodes;                   ///< Number of nodes searched
+};
+
+/**
+ * @brief Alpha-beta solver for short remaining horizons, e.g. when MAX_ROUND is near or a base is
+ * about to fall.
+ *
+ * Rounds are searched as alternating moves: player 0 applies operations, player 1 applies
+ * operations after seeing them, and then the round is settled, just like in Simulator. Game ends
+ * are scored as in Simulator::next_round(), and positions at the horizon by a heuristic
+ * evaluation, so a result is resolved only when every line it depends on ends the game.
+ *
+ * Each move is a set of at most one operation taken from a list of candidates likely to matter in
+ * an endgame: super weapons around the most advanced ants, towers near ants approaching own base,
+ * upgrades of own towers, and doing nothing. Candidates are ordered by a static guess, with the
+ * best move of the transposition table tried first. Both sides only play candidates, so outcomes
+ * hold within candidate moves rather than over all legal moves (see EndgameOutcome).
+ *
+ * @code
+ * EndgameSolver solver;
+ * EndgameResult result = solver.solve(c.get_info(), c.self_player_id, 4);
+ * if (result.outcome == EndgameOutcome::CandidateWin)
+ *     for (auto& op: result.operations)
+ *         c.append_self_operation(op);
+ * @endcode
+ */
+class EndgameSolver
+{
+public:
+    static constexpr int WIN_SCORE = 1 << 20; ///< Score of a win right now. Later wins score less.
+    static constexpr int MAX_HEURISTIC = 1 << 18; ///< Bound of heuristic scores
+
+    /**
+     * @brief Limits of a search.
+     */
+    struct Options
+    {
+        long long max_nodes = 200000; ///< Node limit, after which the search gives up
+        int max_candidates = 12;      ///< Number of candidate moves tried in each position
+        int table_bits = 18;          ///< Log2 of the number of transposition table entries
+    };
+
+private:
+    /**
+     * @brief Bound kind of a stored score.
+     */
+    enum Bound : std::uint8_t
+    {
+        Exact,
+        Lower,
+        Upper
+    };
+
+    struct Entry
+    {
+        std::uint64_t key = 0;
+        int score = 0;
+        std::int16_t depth = -1;
+        Bound bound = Exact;
+        std::int8_t best = -1; ///< Index of the best move among candidates, or -1 if unknown
+    };
+
+    Options options;
+    std::vector<Entry> table;
+    long long nodes = 0;
+    bool aborted = false;
+
+    /**
+     * @brief Estimate how good a position is for a player, within (-MAX_HEURISTIC, MAX_HEURISTIC).
+     */
+    static int evaluate(const GameInfo& info, int player)
+    {
+        int score = (info.bases[player].hp - info.bases[!player].hp) * 1000;
+        score += (info.coins[player] - info.coins[!player]);
+        // Ants close to their target count as potential damage
+        for (const Ant& ant: info.ants)
+        {
+            int d = distance(ant.x, ant.y, Base::POSITION[!ant.player][0], Base::POSITION[!ant.player][1]);
+            int threat = (ant.level + 1) * 20 / (d + 1);
+            score += ant.player == player ? threat : -threat;
+        }
+        return std::max(-MAX_HEURISTIC + 1, std::min(MAX_HEURISTIC - 1, score));
+    }
+
+    /**
+     * @brief Score of a finished game for a player, preferring quick wins and slow losses.
+     * @param ply Number of moves from the root.
+     */
+    static int terminal_score(GameState state, int player, int ply)
+    {
+        if (state == GameState::Undecided)
+            return 0;
+        int winner = state == GameState::Player0Win ? 0 : 1;
+        return winner == player ? WIN_SCORE - ply : -WIN_SCORE + ply;
+    }
+
+    /**
+     * @brief Whether a score is a game end rather than a heuristic evaluation.
+     */
+    static bool is_terminal(int score)
+    {
+        return score >= WIN_SCORE - 2 * MAX_ROUND || score <= -WIN_SCORE + 2 * MAX_ROUND;
+    }
+
+    /**
+     * @brief Convert a score from the root into one relative to a node at "ply", for the
+     * transposition table, so that a stored game end is valid whatever the path to the node.
+     */
+    static int to_table(int score, int ply)
+    {
+        return !is_terminal(score) ? score : score > 0 ? score + ply : score - ply;
+    }
+
+    /**
+     * @brief Convert a score of the transposition table back into one from the root.
+     */
+    static int from_table(int score, int ply)
+    {
+        return !is_terminal(score) ? score : score > 0 ? score - ply : score + ply;
+    }
+
+    /**
+     * @brief List candidate moves of a player, best guesses first.
+     */
+    std::vector<std::vector<Operation>> candidates(const GameInfo& info, int player) const
+    {
+        std::vector<std::pair<int, Operation>> scored;
+        auto consider = [&](int priority, Operation op)
+        {
+            if (info.is_operation_valid(player, op))
+                scored.emplace_back(priority, op);
+        };
+        // Ants sorted by distance to the base they attack
+        std::vector<std::pair<int, const Ant*>> threats[2];
+        for (const Ant& ant: info.ants)
+        {
+            int target = !ant.player;
+            int d = distance(ant.x, ant.y, Base::POSITION[target][0], Base::POSITION[target][1]);
+            threats[ant.player].emplace_back(d, &ant);
+        }
+        for (auto& t: threats)
+            std::sort(t.begin(), t.end(), [](const std::pair<int, const Ant*>& a, const std::pair<int, const Ant*>& b)
+            {
+                return a.first < b.first || (a.first == b.first && a.second->id < b.second->id);
+            });
+        const auto& incoming = threats[!player];
+        const auto& outgoing = threats[player];
+        // Super weapons around the most advanced ants
+        for (size_t i = 0; i < incoming.size() && i < 3; ++i)
+        {
+            const Ant& ant = *incoming[i].second;
+            consider(300 - incoming[i].first, Operation(UseLightningStorm, ant.x, ant.y));
+        }
+        for (size_t i = 0; i < outgoing.size() && i < 3; ++i)
+        {
+            const Ant& ant = *outgoing[i].second;
+            consider(250 - outgoing[i].first, Operation(UseDeflector, ant.x, ant.y));
+            consider(240 - outgoing[i].first, Operation(UseEmergencyEvasion, ant.x, ant.y));
+            consider(230 - outgoing[i].first, Operation(UseEmpBlaster, ant.x, ant.y));
+        }
+        // Towers next to the most advanced incoming ants
+        for (size_t i = 0; i < incoming.size() && i < 2; ++i)
+        {
+            const Ant& ant = *incoming[i].second;
+            for (int x = ant.x - 2; x <= ant.x + 2; ++x)
+                for (int y = ant.y - 2; y <= ant.y + 2; ++y)
+                    if (is_highland(player, x, y) && distance(x, y, ant.x, ant.y) <= 2)
+                        consider(200 - incoming[i].first - distance(x, y, ant.x, ant.y), Operation(BuildTower, x, y));
+        }
+        // Upgrades of own towers
+        for (const Tower& tower: info.towers)
+        {
+            if (tower.player != player)
+                continue;
+            int base = tower.type == TowerType::Basic ? 0 : tower.type * 10;
+            for (int branch = 1; branch <= 3; ++branch)
+                consider(100 + tower.damage, Operation(UpgradeTower, tower.id, base + branch));
+        }
+        std::stable_sort(scored.begin(), scored.end(), [](const std::pair<int, Operation>& a, const std::pair<int, Operation>& b)
+        {
+            return a.first > b.first;
+        });
+        std::vector<std::vector<Operation>> moves;
+        moves.emplace_back(); // Doing nothing is always possible
+        for (auto& p: scored)
+        {
+            bool duplicate = false;
+            for (auto& m: moves)
+                if (!m.empty() && m[0].type == p.second.type && m[0].arg0 == p.second.arg0 && m[0].arg1 == p.second.arg1)
+                    duplicate = true;
+            if (!duplicate)
+                moves.push_back({p.second});
+            if (static_cast<int>(moves.size()) >= options.max_candidates)
+                break;
+        }
+        return moves;
+    }
+
+    /**
+     * @brief Search a position with "player" to move.
+     * @param depth Number of rounds left to search, including current round.
+     * @param ply Number of moves from the root.
+     * @return Score from the view of "player".
+     */
+    int search(Simulator& s, int player, int depth, int ply, int alpha, int beta, std::vector<Operation>* best_move)
+    {
+        if (++nodes > options.max_nodes)
+        {
+            aborted = true;
+            return 0;
+        }
+        const GameInfo& info = s.get_info();
+        std::uint64_t key = GameInfo::hash_combine(info.hash(), player);
+        Entry& entry = table[key & (table.size() - 1)];
+        int preferred = -1;
+        if (entry.key == key)
+        {
+            preferred = entry.best;
+            int score = from_table(entry.score, ply);
+            if (entry.depth >= depth && !best_move)
+            {
+                if (entry.bound == Exact
+                    || (entry.bound == Lower && score >= beta)
+                    || (entry.bound == Upper && score <= alpha))
+                    return score;
+            }
+        }
+
+        std::vector<std::vector<Operation>> moves = candidates(info, player);
+        std::vector<int> order(moves.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        if (preferred > 0 && preferred < static_cast<int>(moves.size()))
+            std::rotate(order.begin(), order.begin() + preferred, order.begin() + preferred + 1);
+
+        int original_alpha = alpha, best = -WIN_SCORE - 1, best_index = -1;
+        for (int i: order)
+        {
+            Simulator child(s);
+            for (auto& op: moves[i])
+                child.add_operation_of_player(player, op);
+            child.apply_operations_of_player(player);
+            int score;
+            if (player == 0)
+                score = -search(child, 1, depth, ply + 1, -beta, -alpha, nullptr);
+            else
+            {
+                GameState state = child.next_round();
+                if (state != GameState::Running)
+                    score = terminal_score(state, player, ply + 1);
+                else if (depth <= 1)
+                    score = evaluate(child.get_info(), player);
+                else
+                    score = -search(child, 0, depth - 1, ply + 1, -beta, -alpha, nullptr);
+            }
+            if (aborted)
+                return 0;
+            if (score > best)
+            {
+                best = score;
+                best_index = i;
+                if (best_move)
+                    *best_move = moves[i];
+            }
+            alpha = std::max(alpha, score);
+            if (alpha >= beta)
+                break;
+        }
+
+        entry.key = key;
+        entry.score = to_table(best, ply);
+        entry.depth = depth;
+        entry.bound = best <= original_alpha ? Upper : best >= beta ? Lower : Exact;
+        entry.best = best_index;
+        return best;
+    }
+
+public:
+    EndgameSolver() : EndgameSolver(Options()) {}
+
+    explicit EndgameSolver(const Options& options)
+        : options(options), table(std::size_t(1) << options.table_bits) {}
+
+    /**
+     * @brief Solve a position.
+     * @param info Current game state. If player 1 is to move, player 0 must have applied its
+     *        operations of this round, as in the game process of Controller.
+     * @param player The player to move.
+     * @param rounds Horizon of the search, in rounds, including current round.
+     * @return Best operations and what is resolved about them within candidate moves.
+     * @note The transposition table is kept between calls, so consecutive calls in a game benefit
+     * from earlier ones. Game ends are stored relative to their node, so they stay valid.
+     */
+    EndgameResult solve(const GameInfo& info, int player, int rounds)
+    {
+        nodes = 0;
+        aborted = false;
+        rounds = std::max(1, std::min(rounds, MAX_ROUND - info.round + 1));
+        Simulator s(info);
+        EndgameResult result{EndgameOutcome::Unresolved, {}, 0, 0};
+        // Iterative deepening: each finished iteration refines the result, and fills the
+        // transposition table with better move ordering for the next one.
+        for (int depth = 1; depth <= rounds; ++depth)
+        {
+            std::vector<Operation> best_move;
+            int score = search(s, player, depth, 0, -WIN_SCORE - 1, WIN_SCORE + 1, &best_move);
+            if (aborted)
+                break;
+            result.operations = best_move;
+            result.score = score;
+            if (is_terminal(score) && score > 0)
+                result.outcome = EndgameOutcome::CandidateWin;
+            else if (is_terminal(score))
+                result.outcome = EndgameOutcome::CandidateLoss;
+            else if (depth == MAX_ROUND - info.round + 1)
+                result.outcome = EndgameOutcome::CandidateDraw; // Every line reaches the end of the game
+            if (result.outcome != EndgameOutcome::Unresolved)
+                break;
+        }
+        result.nodes = nodes;
+        return result;
+    }
+
+    /**
+     * @brief Discard everything in the transposition table.
+     */
+    void clear()
+    {
+        std::fill(table.begin(), table.end(), Entry());
+    }
+};
@@ -0,0 +1,210 @@
+/**
+ * @file flow_field.hpp
+ * @author Yufei Li, Jingxuan Liu
+ * @brief Expected ant traffic of both players, kept up to date with pheromone.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include "game_info.hpp"
+#include "weapon_placement.hpp"
+
+/**
+ * @brief Flow field of expected ant visits per cell over the next rounds, for ants of each player.
+ *
+ * An ant's move only depends on its cell, its last move and the pheromone of its player around
+ * (GameInfo::next_move()), so the path graph is a successor table over (cell, last move) states.
+ * Spawn flow starts at Base::POSITION and follows it: the k-th cell of the path of a new ant is
+ * visited once by every ant born early enough to get there within the horizon. Alive ants follow
+ * the same table from their own states.
+ *
+ * Successors are computed on demand and cached. update() compares pheromone with what the cache
+ * was computed from, and only drops the successors of states next to changed cells, since a move
+ * only reads pheromone of neighbors. Edits of a few trails, as in what-if searches, thus cost a few
+ * next_move() calls. Note that global_pheromone_attenuation() changes every cell, so updating
+ * across real rounds amounts to recomputing everything.
+ *
+ * Visits are stored as aligned float rows of STRIDE cells indexed by "x * MAP_SIZE + y", padded
+ * with zeros, so that consumers can process whole rows with vector loads. The alignment holds for
+ * automatic and static objects, and for heap objects from C++17 on.
+ *
+ * @code
+ * FlowField flow(32);
+ * ...
+ * flow.update(c.get_info()); // Every round
+ * const float* incoming = flow.visits(!c.self_player_id);
+ * @endcode
+ */
+class FlowField
+{
+public:
+    static constexpr int STRIDE = (MAP_CELLS + 7) / 8 * 8; ///< Row length of visits, a multiple of 8 floats
+    static constexpr int NO_MOVE = 6;                       ///< Last move of an ant that has not moved
+
+private:
+    int horizon;
+    alignas(32) float field[2][STRIDE];        ///< Expected visits by ants of each player, by cell
+    signed char moves[2][MAP_CELLS][7];        ///< Cached next move by cell and last move, -1 if unknown
+    double pheromone[2][MAP_CELLS];            ///< Pheromone the cache is consistent with
+    bool initialized;
+    long long evaluations;
+
+    /**
+     * @brief Drop cached moves of a player that read pheromone of a cell, i.e. moves from its neighbors.
+     */
+    void invalidate_around(int player, int x, int y)
+    {
+        for (int i = 0; i < 6; ++i)
+        {
+            int nx = x + OFFSET[y % 2][i][0], ny = y + OFFSET[y % 2][i][1];
+            if (is_path(nx, ny))
+                std::fill(moves[player][nx * MAP_SIZE + ny], moves[player][nx * MAP_SIZE + ny] + 7, -1);
+        }
+    }
+
+    /**
+     * @brief Walk an ant along cached moves, adding a weight to every cell visited in its first moves.
+     * @param weights Weight of the k-th move for k = 0, 1, ..., i.e. the number of ants making it.
+     */
+    void walk(const GameInfo& info, const Ant& ant, const std::vector<float>& weights)
+    {
+        float* visits = field[ant.player];
+        const int* target = Base::POSITION[!ant.player];
+        // Only the cell and the last move matter, so a probe ant with a one-move path stands in
+        // for the ant when a move is not cached
+        Ant probe(ant.id, ant.player, ant.x, ant.y, ant.hp, ant.level, ant.age, ant.state);
+        int last = ant.path.empty() ? NO_MOVE : ant.path.back();
+        for (std::size_t i = 0; i < weights.size() && probe.age <= Ant::AGE_LIMIT; ++i, ++probe.age)
+        {
+            signed char& move = moves[ant.player][probe.x * MAP_SIZE + probe.y][last];
+            if (move < 0)
+            {
+                probe.path.assign(last == NO_MOVE ? 0 : 1, last);
+                move = info.next_move(probe);
+                ++evaluations;
+            }
+            last = move;
+            probe.x += OFFSET[probe.y % 2][last][0];
+            probe.y += OFFSET[probe.y % 2][last][1];
+            visits[probe.x * MAP_SIZE + probe.y] += weights[i];
+            if (probe.x == target[0] && probe.y == target[1])
+                break;
+        }
+    }
+
+    /**
+     * @brief Count multiples of a positive number in [lo, hi], where lo >= 0.
+     */
+    static int multiples(int lo, int hi, int divisor)
+    {
+        return hi < lo ? 0 : hi / divisor - (lo + divisor - 1) / divisor + 1;
+    }
+
+public:
+    /**
+     * @brief Construct an empty flow field.
+     * @param horizon Number of rounds ahead, i.e. of ant moves counted.
+     */
+    explicit FlowField(int horizon = 32)
+        : horizon(horizon), field{}, pheromone{}, initialized(false), evaluations(0)
+    {
+        std::fill(&moves[0][0][0], &moves[0][0][0] + 2 * MAP_CELLS * 7, -1);
+    }
+
+    /**
+     * @brief Get the number of rounds ahead.
+     */
+    int get_horizon() const
+    {
+        return horizon;
+    }
+
+    /**
+     * @brief Get the number of GameInfo::next_move() calls so far, i.e. of cache misses.
+     */
+    long long get_evaluations() const
+    {
+        return evaluations;
+    }
+
+    /**
+     * @brief Recompute the flow field of a game state, reusing cached moves where pheromone is unchanged.
+     *
+     * Ants move in rounds info.round to info.round + horizon - 1, and bases generate ants at the end
+     * of each round as in Simulator::next_round(), at current generation speed.
+     *
+     * @param info Current game state.
+     * @return Number of cells whose pheromone has changed since last update, over both players.
+     */
+    int update(const GameInfo& info)
+    {
+        int changed = 0;
+        std::vector<int> cells;
+        for (int player = 0; player < 2; ++player)
+        {
+            const double* current = &info.pheromone[player][0][0];
+            cells.clear();
+            for (int cell = 0; cell < MAP_CELLS; ++cell)
+                if (!initialized || pheromone[player][cell] != current[cell])
+                    cells.push_back(cell);
+            std::copy(current, current + MAP_CELLS, pheromone[player]);
+            changed += cells.size();
+            // Dropping everything at once is cheaper when most cells have changed, e.g. every round
+            if (static_cast<int>(cells.size()) > MAP_CELLS / 8)
+                std::fill(&moves[player][0][0], &moves[player][0][0] + MAP_CELLS * 7, -1);
+            else
+                for (int cell: cells)
+                    invalidate_around(player, cell / MAP_SIZE, cell % MAP_SIZE);
+        }
+        initialized = true;
+
+        std::fill(&field[0][0], &field[0][0] + 2 * STRIDE, 0.0f);
+        std::vector<float> weights(horizon);
+        for (const Base& base: info.bases)
+        {
+            // The k-th move of ants born at the end of round s is in round s + k
+            int cycle = Base::GENERATION_CYCLE_INFO[base.gen_speed_level];
+            for (int k = 1; k <= horizon; ++k)
+                weights[k - 1] = multiples(info.round, info.round + horizon - 1 - k, cycle);
+            walk(info, Ant(-1, base.player, base.x, base.y, Ant::MAX_HP_INFO[base.ant_level], base.ant_level,
+                0, AntState::Alive), weights);
+        }
+        std::fill(weights.begin(), weights.end(), 1.0f);
+        for (const Ant& ant: info.ants)
+            if (ant.is_alive())
+                walk(info, ant, weights);
+        return changed;
+    }
+
+    /**
+     * @brief Drop all cached moves, e.g. after the map has changed.
+     */
+    void clear()
+    {
+        std::fill(&moves[0][0][0], &moves[0][0][0] + 2 * MAP_CELLS * 7, -1);
+        initialized = false;
+    }
+
+    /**
+     * @brief Get the expected visits by ants of a player over the horizon, as of last update().
+     * @return Row of STRIDE cells indexed by "x * MAP_SIZE + y", aligned to 32 bytes.
+     */
+    const float* visits(int player) const
+    {
+        return field[player];
+    }
+
+    /**
+     * @brief Get the expected visits to a cell by ants of a player over the horizon.
+     */
+    float visits(int player, int x, int y) const
+    {
+        return field[player][x * MAP_SIZE + y];
+    }
+};
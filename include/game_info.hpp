@@ -15,41 +15,102 @@
 #include <cmath>
 #include <cassert>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include "common.hpp"
 #include "optional.hpp"
 
+/**
+ * @brief Memory used by game state, by component, in bytes.
+ * @note Heap usage is counted by capacities of containers, i.e. what is actually allocated.
+ */
+struct MemoryUsage
+{
+    std::size_t object;        ///< Size of the object itself, including pheromone and bases
+    std::size_t towers;        ///< Heap memory of towers
+    std::size_t ants;          ///< Heap memory of ants, excluding their paths
+    std::size_t ant_paths;     ///< Heap memory of paths of all ants
+    std::size_t super_weapons; ///< Heap memory of super weapons
+    std::size_t operations;    ///< Heap memory of operations (Simulator only)
+    std::size_t schedule;      ///< Heap memory of the schedule of tower attacks (Simulator only)
+
+    /**
+     * @brief Total memory of all components.
+     */
+    std::size_t total() const
+    {
+        return object + towers + ants + ant_paths + super_weapons + operations + schedule;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const MemoryUsage& usage)
+    {
+        out << "object: " << usage.object << ", towers: " << usage.towers << ", ants: " << usage.ants
+            << ", ant_paths: " << usage.ant_paths << ", super_weapons: " << usage.super_weapons
+            << ", operations: " << usage.operations << ", schedule: " << usage.schedule
+            << ", total: " << usage.total() << std::endl;
+        return out;
+    }
+};
+
 /**
  * @brief A module used for game state management, providing interfaces for accessing and modifying 
  * various types of information such as Entity, Economy, Pheromone, SuperWeapon and Operation. 
+ * @tparam Map Map descriptor, see DefaultMap.
  */
-struct GameInfo
+template <typename Map>
+struct BasicGameInfo
 {
     int round;                                      ///< Current round number
     std::vector<Tower> towers;                      ///< All towers on the map
     std::vector<Ant> ants;                          ///< All ants on the map
     Base bases[2];                                  ///< Bases of both sides: "bases[player_id]"
     int coins[2];                                   ///< Coins of both sides: "coins[player_id]"
-    double pheromone[2][MAP_SIZE][MAP_SIZE];        ///< Pheromone of each point on the map: "pheromone[player_id][x][y]"
+    double pheromone[2][Map::SIZE][Map::SIZE];      ///< Pheromone of each point on the map: "pheromone[player_id][x][y]"
     std::vector<SuperWeapon> super_weapons;         ///< Super weapons being used
     int super_weapon_cd[2][SuperWeaponCount];       ///< Super weapon cooldown of both sides: "super_weapon_cd[player_id]"
     
     int next_ant_id;                                ///< ID of the next generated ant.
     int next_tower_id;                              ///< ID of the next built tower.
 
-    GameInfo(unsigned long long seed)
-        : round(0), bases{Base(0), Base(1)}, coins{COIN_INIT, COIN_INIT},
+    BasicGameInfo(unsigned long long seed)
+        : round(0), bases{Base(0, Map::base_x(0), Map::base_y(0)), Base(1, Map::base_x(1), Map::base_y(1))},
+          coins{COIN_INIT, COIN_INIT},
           super_weapon_cd{}, next_ant_id(0), next_tower_id(0)
     {
         // Initialize pheromone
         Random random(seed);
         for(int i = 0; i < 2; i++)
-            for(int j = 0; j < MAP_SIZE; j++)
-                for(int k = 0; k < MAP_SIZE; k++)
+            for(int j = 0; j < Map::SIZE; j++)
+                for(int k = 0; k < Map::SIZE; k++)
                     pheromone[i][j][k] = random.get() * std::pow(2, -46) + 8;
     }
 
+    /**
+     * @brief Copy another game state into this one, reusing memory allocated for towers, ants and
+     * their paths. Bases have constant members, so BasicGameInfo itself is not assignable.
+     * @param other The game state to copy.
+     */
+    void assign(const BasicGameInfo& other)
+    {
+        round = other.round;
+        towers = other.towers;
+        ants = other.ants;
+        for (int i = 0; i < 2; ++i)
+        {
+            bases[i].hp = other.bases[i].hp;
+            bases[i].gen_speed_level = other.bases[i].gen_speed_level;
+            bases[i].ant_level = other.bases[i].ant_level;
+        }
+        std::copy(other.coins, other.coins + 2, coins);
+        std::copy(&other.pheromone[0][0][0], &other.pheromone[0][0][0] + 2 * Map::SIZE * Map::SIZE, &pheromone[0][0][0]);
+        super_weapons = other.super_weapons;
+        std::copy(&other.super_weapon_cd[0][0], &other.super_weapon_cd[0][0] + 2 * SuperWeaponCount, &super_weapon_cd[0][0]);
+        next_ant_id = other.next_ant_id;
+        next_tower_id = other.next_tower_id;
+    }
+
     /* Getters */
 
     /**
@@ -299,8 +360,8 @@ struct GameInfo
         // Update pheromone from start to end
         int tau = TAU[ant.state];
         int player = ant.player;
-        int x = Base::POSITION[player][0], y = Base::POSITION[player][1];
-        bool visited[MAP_SIZE][MAP_SIZE] = {};
+        int x = Map::base_x(player), y = Map::base_y(player);
+        bool visited[Map::SIZE][Map::SIZE] = {};
         
         for (int move: ant.path)
         {
@@ -327,14 +388,66 @@ struct GameInfo
         }
     }
 
+    /**
+     * @brief Update pheromone at the end of a round: global attenuation, then the update of each
+     * ant in order. Same as global_pheromone_attenuation() followed by update_pheromone_for_ants(),
+     * in a single call.
+     *
+     * Attenuation is one flat pass over both players. Deposits are applied in ant order with
+     * clamping per write, touching only cells on paths, and cells already visited by an ant are
+     * told by stamps instead of clearing a map per ant. Summing deposits into a delta grid first
+     * would not be exact, as clamping and rounding depend on the order of writes.
+     */
+    void update_pheromone_for_round()
+    {
+        static constexpr double TAU[] = {0.0, 10.0, -5, -3};
+        static constexpr double BIAS = (1 - PHEROMONE_ATTENUATING_RATIO) * PHEROMONE_INIT;
+        double* cells = &pheromone[0][0][0];
+        for (int i = 0; i < 2 * Map::SIZE * Map::SIZE; ++i)
+            cells[i] = PHEROMONE_ATTENUATING_RATIO * cells[i] + BIAS;
+
+        int stamps[Map::SIZE][Map::SIZE]; // Index of the last ant that visited each cell
+        bool stamped = false;
+        for (std::size_t i = 0; i < ants.size(); ++i)
+        {
+            const Ant& ant = ants[i];
+            if (ant.state == AntState::Alive || ant.state == AntState::Frozen)
+                continue;
+            if (!stamped)
+            {
+                std::fill(&stamps[0][0], &stamps[0][0] + Map::SIZE * Map::SIZE, -1);
+                stamped = true;
+            }
+            double tau = TAU[ant.state];
+            double (&p)[Map::SIZE][Map::SIZE] = pheromone[ant.player];
+            int x = Map::base_x(ant.player), y = Map::base_y(ant.player);
+            for (std::size_t k = 0; k <= ant.path.size(); ++k)
+            {
+                if (stamps[x][y] != static_cast<int>(i))
+                {
+                    stamps[x][y] = i;
+                    p[x][y] += tau;
+                    if (p[x][y] < PHEROMONE_MIN)
+                        p[x][y] = PHEROMONE_MIN;
+                }
+                if (k == ant.path.size())
+                    break;
+                int move = ant.path[k];
+                x += OFFSET[y % 2][move][0];
+                y += OFFSET[y % 2][move][1];
+            }
+            assert(x == ant.x && y == ant.y);
+        }
+    }
+
     /**
      * @brief Global pheromone attenuation.
      */
     void global_pheromone_attenuation()
     {
         for (int i = 0; i < 2; ++i)
-            for (int j = 0; j < MAP_SIZE; ++j)
-                for (int k = 0; k < MAP_SIZE; ++k)
+            for (int j = 0; j < Map::SIZE; ++j)
+                for (int k = 0; k < Map::SIZE; ++k)
                     pheromone[i][j][k] =
                         PHEROMONE_ATTENUATING_RATIO * pheromone[i][j][k]
                         + (1 - PHEROMONE_ATTENUATING_RATIO) * PHEROMONE_INIT;
@@ -371,7 +484,7 @@ struct GameInfo
         switch (op.type)
         {
             case BuildTower:
-                return is_highland(player_id, op.arg0, op.arg1)
+                return Map::is_highland(player_id, op.arg0, op.arg1)
                        && !tower_at(op.arg0, op.arg1)
                        && !is_shielded_by_emp(player_id, op.arg0, op.arg1);
             case UpgradeTower:
@@ -391,7 +504,7 @@ struct GameInfo
             case UseEmpBlaster:
             case UseDeflector:
             case UseEmergencyEvasion:
-                return  is_valid_pos(op.arg0, op.arg1)
+                return  Map::is_valid_pos(op.arg0, op.arg1)
                         && super_weapon_cd[player_id][op.type % 10] <= 0;
             case UpgradeGenerationSpeed:
                 return bases[player_id].gen_speed_level < 2;
@@ -585,8 +698,8 @@ struct GameInfo
         static constexpr int ETA_OFFSET = 1;
 
         // Data
-        int target_x = Base::POSITION[!ant.player][0],
-            target_y = Base::POSITION[!ant.player][1];
+        int target_x = Map::base_x(!ant.player),
+            target_y = Map::base_y(!ant.player);
         int cur_dist = distance(ant.x, ant.y, target_x, target_y);
 
         // Store weighted and original pheromone
@@ -601,7 +714,7 @@ struct GameInfo
             int x = ant.x + OFFSET[ant.y % 2][i][0],
                 y = ant.y + OFFSET[ant.y % 2][i][1];
             // Valid: not blocked and not going back
-            if ((!ant.path.empty() && ant.path.back() == (i + 3) % 6) || !is_path(x, y))
+            if ((!ant.path.empty() && ant.path.back() == (i + 3) % 6) || !Map::is_path(x, y))
                 continue;
             // Weight (Atrract)
             int next_dist = distance(x, y, target_x, target_y);
@@ -802,8 +915,99 @@ struct GameInfo
                 super_weapon_cd[i][j] = std::max(super_weapon_cd[i][j] - 1, 0);
     }
 
+    /* Hashing */
+
+    /**
+     * @brief Mix a value into a hash.
+     * @param h Current hash.
+     * @param value The value.
+     * @return New hash.
+     */
+    static std::uint64_t hash_combine(std::uint64_t h, std::uint64_t value)
+    {
+        // Finalizer of splitmix64
+        h ^= value + 0x9e3779b97f4a7c15ULL;
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        return h ^ (h >> 31);
+    }
+
+    /**
+     * @brief Get a 64-bit hash of current game state, e.g. as the key of a transposition table.
+     * @return The hash, which is equal for equal states.
+     * @note Everything affecting later rounds is hashed, including pheromone and ants' paths.
+     * Pheromone is hashed by bit pattern.
+     */
+    std::uint64_t hash() const
+    {
+        std::uint64_t h = hash_combine(0, round);
+        h = hash_combine(h, next_ant_id);
+        h = hash_combine(h, next_tower_id);
+        for (int i = 0; i < 2; ++i)
+        {
+            h = hash_combine(h, coins[i]);
+            h = hash_combine(h, bases[i].hp);
+            h = hash_combine(h, bases[i].gen_speed_level << 8 | bases[i].ant_level);
+            for (int j = 0; j < SuperWeaponCount; ++j)
+                h = hash_combine(h, super_weapon_cd[i][j]);
+        }
+        for (const Tower& tower: towers)
+        {
+            h = hash_combine(h, tower.id);
+            h = hash_combine(h, tower.player << 24 | tower.x << 16 | tower.y << 8 | tower.type);
+            h = hash_combine(h, tower.cd);
+        }
+        h = hash_combine(h, towers.size());
+        for (const Ant& ant: ants)
+        {
+            h = hash_combine(h, ant.id);
+            h = hash_combine(h, ant.player << 24 | ant.x << 16 | ant.y << 8 | ant.level);
+            h = hash_combine(h, static_cast<std::uint64_t>(ant.hp) << 32 | ant.age << 8 | ant.state);
+            h = hash_combine(h, ant.evasion << 1 | ant.deflector);
+            for (int move: ant.path)
+                h = hash_combine(h, move);
+            h = hash_combine(h, ant.path.size());
+        }
+        h = hash_combine(h, ants.size());
+        for (const SuperWeapon& sw: super_weapons)
+        {
+            h = hash_combine(h, sw.type << 24 | sw.player << 16 | sw.x << 8 | sw.y);
+            h = hash_combine(h, sw.left_time);
+        }
+        h = hash_combine(h, super_weapons.size());
+        // Pheromone takes most of the time, so it is hashed in independent lanes and mixed at the end
+        const double* cells = &pheromone[0][0][0];
+        const int n = 2 * Map::SIZE * Map::SIZE;
+        std::uint64_t lanes[4] = {1, 2, 3, 4};
+        for (int i = 0; i < n; ++i)
+        {
+            std::uint64_t bits;
+            std::memcpy(&bits, &cells[i], sizeof(bits));
+            lanes[i & 3] = (lanes[i & 3] ^ bits) * 0x100000001b3ULL;
+        }
+        for (std::uint64_t lane: lanes)
+            h = hash_combine(h, lane);
+        return h;
+    }
+
     /* For debug */
 
+    /**
+     * @brief Get memory used by this object, by component.
+     * @return Memory usage in bytes.
+     */
+    MemoryUsage memory_usage() const
+    {
+        MemoryUsage usage = {};
+        usage.object = sizeof(*this);
+        usage.towers = towers.capacity() * sizeof(Tower);
+        usage.ants = ants.capacity() * sizeof(Ant);
+        for (const Ant& ant: ants)
+            usage.ant_paths += ant.path.capacity() * sizeof(int);
+        usage.super_weapons = super_weapons.capacity() * sizeof(SuperWeapon);
+        return usage;
+    }
+
     /**
      * @brief Print current information to file "info.out".
      */
@@ -865,9 +1069,9 @@ struct GameInfo
         // Pheromone
         for (int player = 0; player < 2; ++player)
         {
-            for (int i = 0; i < MAP_SIZE; ++i)
+            for (int i = 0; i < Map::SIZE; ++i)
             {
-                for (int j = 0; j < MAP_SIZE; ++j)
+                for (int j = 0; j < Map::SIZE; ++j)
                 {
                     fout << std::fixed << std::setprecision(4) << pheromone[player][i][j] << ' ';
                 }
@@ -886,3 +1090,8 @@ struct GameInfo
         fout.close();
     }
 };
+
+/**
+ * @brief Game state on the default map.
+ */
+using GameInfo = BasicGameInfo<DefaultMap>;
@@ -16,98 +16,535 @@
 #include <iostream>
 #include "common.hpp"
 
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#endif
+
+#if __cplusplus >= 201703L
+#include <charconv>
+#include <string_view>
+#endif
+
 /* Input */
 
+/**
+ * @brief Reader of whitespace-separated integers in messages from judger.
+ * @note Since C++17, input is read line by line and parsed with std::from_chars over
+ * std::string_view, which is much faster than formatted input of iostream. Every message
+ * of judger ends with a line break, so nothing is lost when a reader is destroyed at the
+ * end of a message. Before C++17, it simply falls back to "operator>>" of the stream.
+ */
+class IntReader
+{
+private:
+    std::istream& in;
+#if __cplusplus >= 201703L
+    std::string line;      ///< Current line
+    std::string_view rest; ///< Unparsed part of current line
+#endif
+
+public:
+    /**
+     * @brief Construct a reader on given stream.
+     * @param in The stream to read from.
+     */
+    explicit IntReader(std::istream& in) : in(in) {}
+
+    /**
+     * @brief Read an integer.
+     * @param x Reference to the result.
+     * @return Reference to this reader, for chained reading.
+     */
+    template <typename T>
+    IntReader& operator>>(T& x)
+    {
+#if __cplusplus >= 201703L
+        while (true)
+        {
+            auto begin = rest.find_first_not_of(" \t\r");
+            if (begin != std::string_view::npos)
+            {
+                rest.remove_prefix(begin);
+                auto result = std::from_chars(rest.data(), rest.data() + rest.size(), x);
+                if (result.ec != std::errc())
+                {
+                    in.setstate(std::ios::failbit);
+                    rest = {};
+                    return *this;
+                }
+                rest.remove_prefix(result.ptr - rest.data());
+                return *this;
+            }
+            // Current line is exhausted
+            if (!std::getline(in, line))
+                return *this;
+            rest = line;
+        }
+#else
+        in >> x;
+        return *this;
+#endif
+    }
+};
+
 using InitInfo = std::pair<int, unsigned long long>;
 
+/**
+ * @brief A combination of deserialized information about current round state received from judger.
+ */ 
+struct RoundInfo
+{
+    int round;
+    std::vector<Tower> towers;
+    std::vector<Ant> ants;
+    int coin0, coin1, hp0, hp1;
+};
+
+/* Shared-memory transport */
+
+#ifdef __linux__
+#define ANTWAR_SHM_SUPPORTED
+
+/**
+ * @brief One direction of the shared-memory transport: a single-producer/single-consumer ring of
+ * bytes in memory shared by two processes, like SpscQueue in async_io.hpp.
+ *
+ * A side that finds the ring empty (reader) or full (writer) spins briefly when there are other
+ * cores to run its peer, and then sleeps on a futex of the position it waits for. Its peer
+ * makes a wake-up system call only if it is asleep. All fields start as zero, so a zero-filled
+ * shared mapping is an empty ring.
+ */
+class ShmRing
+{
+public:
+    static constexpr std::uint32_t CAPACITY = 1 << 16; ///< Size of the ring in bytes, a power of 2
+
+private:
+    alignas(64) std::atomic<std::uint32_t> head;   ///< Bytes read, owned by the reader
+    std::atomic<std::uint32_t> writer_sleeping;
+    alignas(64) std::atomic<std::uint32_t> tail;   ///< Bytes published, owned by the writer
+    std::atomic<std::uint32_t> reader_sleeping;
+    std::uint32_t pending;                         ///< Bytes written after tail but not published yet
+    alignas(64) char data[CAPACITY];
+
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "futex words must be plain 32-bit integers");
+
+    /**
+     * @brief Wait until a position is no longer "value", or a deadline passes.
+     * @return Whether it has changed.
+     */
+    static bool wait_change(std::atomic<std::uint32_t>& position, std::uint32_t value,
+        std::atomic<std::uint32_t>& sleeping, std::chrono::steady_clock::time_point deadline)
+    {
+        static const int spins = std::thread::hardware_concurrency() > 1 ? 4000 : 0;
+        for (int i = 0; i < spins; ++i)
+            if (position.load(std::memory_order_acquire) != value)
+                return true;
+        while (position.load(std::memory_order_acquire) == value)
+        {
+            sleeping.store(1);
+            if (position.load() != value)
+                break;
+            long long left = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now()).count();
+            if (left <= 0)
+            {
+                sleeping.store(0);
+                return false;
+            }
+            bool forever = deadline == std::chrono::steady_clock::time_point::max();
+            timespec timeout{static_cast<time_t>(left / 1000000000), static_cast<long>(left % 1000000000)};
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&position), FUTEX_WAIT, value,
+                forever ? nullptr : &timeout, nullptr, 0);
+        }
+        sleeping.store(0);
+        return true;
+    }
+
+    static void wake(std::atomic<std::uint32_t>& position, std::atomic<std::uint32_t>& sleeping)
+    {
+        if (sleeping.load())
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&position), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+public:
+    /**
+     * @brief Write bytes, waiting for the reader while the ring is full. Nothing is visible to
+     * the reader before publish(). Called by the writer only.
+     */
+    void write(const void* src, std::size_t size)
+    {
+        const char* p = static_cast<const char*>(src);
+        while (size > 0)
+        {
+            std::uint32_t t = tail.load(std::memory_order_relaxed) + pending;
+            std::uint32_t h = head.load(std::memory_order_acquire);
+            std::uint32_t space = CAPACITY - (t - h);
+            if (space == 0)
+            {
+                publish();
+                wait_change(head, h, writer_sleeping, std::chrono::steady_clock::time_point::max());
+                continue;
+            }
+            std::uint32_t offset = t & (CAPACITY - 1);
+            std::uint32_t n = std::min<std::size_t>({size, space, CAPACITY - offset});
+            std::memcpy(data + offset, p, n);
+            pending += n;
+            p += n;
+            size -= n;
+        }
+    }
+
+    /**
+     * @brief Make written bytes visible to the reader. Called by the writer only.
+     */
+    void publish()
+    {
+        tail.store(tail.load(std::memory_order_relaxed) + pending);
+        pending = 0;
+        wake(tail, reader_sleeping);
+    }
+
+    /**
+     * @brief Read bytes, waiting for the writer while the ring is empty. Called by the reader only.
+     * @param deadline Time after which to give up.
+     * @return Whether all bytes have been read before the deadline.
+     */
+    bool read(void* dest, std::size_t size, std::chrono::steady_clock::time_point deadline)
+    {
+        char* p = static_cast<char*>(dest);
+        while (size > 0)
+        {
+            std::uint32_t h = head.load(std::memory_order_relaxed);
+            std::uint32_t t = tail.load(std::memory_order_acquire);
+            if (t == h)
+            {
+                if (!wait_change(tail, t, reader_sleeping, deadline))
+                    return false;
+                continue;
+            }
+            std::uint32_t offset = h & (CAPACITY - 1);
+            std::uint32_t n = std::min<std::size_t>({size, t - h, CAPACITY - offset});
+            std::memcpy(p, data + offset, n);
+            head.store(h + n);
+            wake(head, writer_sleeping);
+            p += n;
+            size -= n;
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Shared-memory transport between a local judger and a bot, in place of stdin and stdout.
+ *
+ * The judger creates a region of two rings with create() and starts the bot with environment
+ * variable ANTWAR_SHM set to its path. The bot opens it with open(), which is done by
+ * shm_transport() on first use, and then every function of this file reading std::cin or
+ * writing std::cout goes through the transport instead. Messages carry the same contents as the
+ * text protocol in binary: a 32-bit length followed by 32-bit integers, so nothing is formatted
+ * or parsed as text.
+ */
+class ShmTransport
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    struct Region
+    {
+        ShmRing to_bot;
+        ShmRing to_judger;
+    };
+
+    Region* region;
+    ShmRing* in;
+    ShmRing* out;
+    std::string path;                 ///< Path of the region, if owned, i.e. created by this side
+    std::vector<std::int32_t> buffer; ///< Current message
+
+    ShmTransport(Region* region, bool judger, std::string path)
+        : region(region), in(judger ? &region->to_judger : &region->to_bot),
+          out(judger ? &region->to_bot : &region->to_judger), path(std::move(path)) {}
+
+    static Region* map(int fd)
+    {
+        void* p = mmap(nullptr, sizeof(Region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        return p == MAP_FAILED ? nullptr : static_cast<Region*>(p);
+    }
+
+    void send()
+    {
+        std::uint32_t size = buffer.size() * sizeof(std::int32_t);
+        out->write(&size, sizeof(size));
+        out->write(buffer.data(), size);
+        out->publish();
+    }
+
+    bool receive(Clock::time_point deadline)
+    {
+        std::uint32_t size;
+        if (!in->read(&size, sizeof(size), deadline) || size % sizeof(std::int32_t) || size > (1u << 24))
+            return false;
+        buffer.resize(size / sizeof(std::int32_t));
+        return in->read(buffer.data(), size, deadline);
+    }
+
+public:
+    ShmTransport(const ShmTransport&) = delete;
+    ShmTransport& operator=(const ShmTransport&) = delete;
+
+    ~ShmTransport()
+    {
+        munmap(region, sizeof(Region));
+        if (!path.empty())
+            unlink(path.c_str());
+    }
+
+    /**
+     * @brief Create a region as the judger side. It is removed when the transport is destroyed.
+     * @param path Path of the region, e.g. under /dev/shm.
+     * @return The transport, or null on failure.
+     */
+    static std::unique_ptr<ShmTransport> create(const std::string& path)
+    {
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0)
+            return nullptr;
+        Region* region = ftruncate(fd, sizeof(Region)) == 0 ? map(fd) : (close(fd), nullptr);
+        if (!region)
+        {
+            unlink(path.c_str());
+            return nullptr;
+        }
+        return std::unique_ptr<ShmTransport>(new ShmTransport(region, true, path));
+    }
+
+    /**
+     * @brief Open a region created by the judger, as the bot side.
+     * @return The transport, or null on failure.
+     */
+    static std::unique_ptr<ShmTransport> open(const std::string& path)
+    {
+        int fd = ::open(path.c_str(), O_RDWR);
+        Region* region = fd < 0 ? nullptr : map(fd);
+        return std::unique_ptr<ShmTransport>(region ? new ShmTransport(region, false, "") : nullptr);
+    }
+
+    void send_init_info(const InitInfo& init)
+    {
+        buffer.assign({init.first, static_cast<std::int32_t>(init.second), static_cast<std::int32_t>(init.second >> 32)});
+        send();
+    }
+
+    InitInfo read_init_info()
+    {
+        if (!receive(Clock::time_point::max()) || buffer.size() != 3)
+            throw std::runtime_error("malformed init info from shared memory");
+        return {buffer[0], static_cast<std::uint32_t>(buffer[1]) | static_cast<unsigned long long>(static_cast<std::uint32_t>(buffer[2])) << 32};
+    }
+
+    void send_operations(const std::vector<Operation>& ops)
+    {
+        buffer.assign(1, ops.size());
+        for (auto& op: ops)
+            buffer.insert(buffer.end(), {op.type, op.arg0, op.arg1});
+        send();
+    }
+
+    /**
+     * @brief Read operations.
+     * @param ops Result.
+     * @param deadline Time after which to give up, e.g. the time limit of a turn.
+     * @return Whether well-formed operations have been read in time.
+     */
+    bool read_operations(std::vector<Operation>& ops, Clock::time_point deadline = Clock::time_point::max())
+    {
+        if (!receive(deadline) || buffer.empty() || buffer.size() != 1 + 3 * static_cast<std::size_t>(buffer[0]))
+            return false;
+        ops.clear();
+        for (std::size_t i = 1; i < buffer.size(); i += 3)
+            ops.emplace_back(static_cast<OperationType>(buffer[i]), buffer[i + 1], buffer[i + 2]);
+        return true;
+    }
+
+    void send_round_info(const RoundInfo& info)
+    {
+        buffer.assign({info.round, static_cast<std::int32_t>(info.towers.size())});
+        for (const Tower& t: info.towers)
+            buffer.insert(buffer.end(), {t.id, t.player, t.x, t.y, t.type, t.cd});
+        buffer.push_back(info.ants.size());
+        for (const Ant& a: info.ants)
+            buffer.insert(buffer.end(), {a.id, a.player, a.x, a.y, a.hp, a.level, a.age, a.state});
+        buffer.insert(buffer.end(), {info.coin0, info.coin1, info.hp0, info.hp1});
+        send();
+    }
+
+    RoundInfo read_round_info()
+    {
+        RoundInfo info;
+        bool ok = receive(Clock::time_point::max()) && buffer.size() >= 2;
+        std::size_t i = 2, towers = ok ? buffer[1] : 0;
+        ok = ok && buffer.size() >= i + 6 * towers + 1;
+        for (std::size_t k = 0; ok && k < towers; ++k, i += 6)
+            info.towers.emplace_back(buffer[i], buffer[i + 1], buffer[i + 2], buffer[i + 3],
+                static_cast<TowerType>(buffer[i + 4]), buffer[i + 5]);
+        std::size_t ants = ok ? buffer[i++] : 0;
+        ok = ok && buffer.size() == i + 8 * ants + 4;
+        for (std::size_t k = 0; ok && k < ants; ++k, i += 8)
+            info.ants.emplace_back(buffer[i], buffer[i + 1], buffer[i + 2], buffer[i + 3], buffer[i + 4],
+                buffer[i + 5], buffer[i + 6], static_cast<AntState>(buffer[i + 7]));
+        if (!ok)
+            throw std::runtime_error("malformed round info from shared memory");
+        info.round = buffer[0];
+        info.coin0 = buffer[i];
+        info.coin1 = buffer[i + 1];
+        info.hp0 = buffer[i + 2];
+        info.hp1 = buffer[i + 3];
+        return info;
+    }
+};
+
+constexpr std::uint32_t ShmRing::CAPACITY;
+
+/**
+ * @brief Get the shared-memory transport selected by environment variable ANTWAR_SHM.
+ * @return The transport, or null if ANTWAR_SHM is not set, as in the real game.
+ * @throw std::runtime_error if ANTWAR_SHM is set but its region cannot be opened.
+ */
+inline ShmTransport* shm_transport()
+{
+    static std::unique_ptr<ShmTransport> transport = []
+    {
+        const char* path = std::getenv("ANTWAR_SHM");
+        if (!path)
+            return std::unique_ptr<ShmTransport>();
+        auto opened = ShmTransport::open(path);
+        if (!opened)
+            throw std::runtime_error("cannot open shared memory of ANTWAR_SHM");
+        return opened;
+    }();
+    return transport.get();
+}
+#endif
+
 /** 
  * @brief Read information for initialization.
+ * @param in (Optional) The stream to read from, with std::cin as default. Reading std::cin goes
+ *        through the shared-memory transport instead when ANTWAR_SHM is set (see shm_transport()).
  * @return Your player ID and the seed for random number generator, together in a pair.
  */
-inline InitInfo read_init_info()
+inline InitInfo read_init_info(std::istream& in = std::cin)
 {
+#ifdef ANTWAR_SHM_SUPPORTED
+    if (&in == &std::cin && shm_transport())
+        return shm_transport()->read_init_info();
+#endif
     int self_player_id;
     unsigned long long seed;
-    std::cin >> self_player_id >> seed;
+    IntReader reader(in);
+    reader >> self_player_id >> seed;
     return {self_player_id, seed};
 }
 
 /**
  * @brief Read your opponent's operations and deserialize them. The time to call this
  * function depends on your player ID.
+ * @param in (Optional) The stream to read from, with std::cin as default. Reading std::cin goes
+ *        through the shared-memory transport instead when ANTWAR_SHM is set (see shm_transport()).
  * @return A vector of Operation objects.
  */
-inline std::vector<Operation> read_opponent_operations()
+inline std::vector<Operation> read_opponent_operations(std::istream& in = std::cin)
 {
     std::vector<Operation> ops;
-    int count, type, arg0, arg1 = -1;
-    std::cin >> count;
+#ifdef ANTWAR_SHM_SUPPORTED
+    if (&in == &std::cin && shm_transport())
+    {
+        if (!shm_transport()->read_operations(ops))
+            throw std::runtime_error("malformed operations from shared memory");
+        return ops;
+    }
+#endif
+    int count = 0, type, arg0, arg1 = -1;
+    IntReader reader(in);
+    reader >> count;
     ops.reserve(count);
     for (int i = 0; i < count; i++)
     {
-        std::cin >> type;
+        reader >> type;
         if (type == UpgradeGeneratedAnt || type == UpgradeGenerationSpeed)
         {
             ops.emplace_back(static_cast<OperationType>(type));   
         }
         else if (type == DowngradeTower)
         {
-            std::cin >> arg0;
+            reader >> arg0;
             ops.emplace_back(static_cast<OperationType>(type), arg0);
         }
         else
         {
-            std::cin >> arg0 >> arg1;
+            reader >> arg0 >> arg1;
             ops.emplace_back(static_cast<OperationType>(type), arg0, arg1);
         }
     }
     return ops;
 }
 
-/**
- * @brief A combination of deserialized information about current round state received from judger.
- */ 
-struct RoundInfo
-{
-    int round;
-    std::vector<Tower> towers;
-    std::vector<Ant> ants;
-    int coin0, coin1, hp0, hp1;
-};
-
 /**
  * @brief Read information at the beginning of a round and deserialize.
+ * @param in (Optional) The stream to read from, with std::cin as default. Reading std::cin goes
+ *        through the shared-memory transport instead when ANTWAR_SHM is set (see shm_transport()).
  * @return A RoundInfo object with everything received and deserialized.
  */
-inline RoundInfo read_round_info()
+inline RoundInfo read_round_info(std::istream& in = std::cin)
 {
+#ifdef ANTWAR_SHM_SUPPORTED
+    if (&in == &std::cin && shm_transport())
+        return shm_transport()->read_round_info();
+#endif
     RoundInfo info;
+    IntReader reader(in);
     // Round ID
-    std::cin >> info.round;
+    reader >> info.round;
     // Variables
     int id, player, x, y, type, cd, hp, level, age, state;
     // Tower
-    int tower_num;
-    std::cin >> tower_num;
+    int tower_num = 0;
+    reader >> tower_num;
     info.towers.reserve(tower_num);
     for (int i = 0; i < tower_num; ++i)
     {
-        std::cin >> id >> player >> x >> y >> type >> cd;
+        reader >> id >> player >> x >> y >> type >> cd;
         info.towers.emplace_back(id, player, x, y, static_cast<TowerType>(type), cd);
     }
     // Ant
-    int ant_num;
-    std::cin >> ant_num;
+    int ant_num = 0;
+    reader >> ant_num;
     info.ants.reserve(ant_num);
     for (int i = 0; i < ant_num; ++i)
     {
-        std::cin >> id >> player >> x >> y >> hp >> level >> age >> state;
+        reader >> id >> player >> x >> y >> hp >> level >> age >> state;
         info.ants.emplace_back(id, player, x, y, hp, level, age, static_cast<AntState>(state));
     }
     // Coin
-    std::cin >> info.coin0 >> info.coin1;
+    reader >> info.coin0 >> info.coin1;
     // Base hp
-    std::cin >> info.hp0 >> info.hp1;
+    reader >> info.hp0 >> info.hp1;
 
     return info;
 }
@@ -216,9 +653,17 @@ inline void send_string(const std::string& str)
 /**
  * @brief Send some serialized operations with header to judger.
  * @param ops A vector of Operation objects to be sent.
+ * @note They go through the shared-memory transport instead when ANTWAR_SHM is set (see shm_transport()).
  */
 inline void send_operations(const std::vector<Operation>& ops)
 {
+#ifdef ANTWAR_SHM_SUPPORTED
+    if (shm_transport())
+    {
+        shm_transport()->send_operations(ops);
+        return;
+    }
+#endif
     // Get the total length, including the leading operation num
     std::size_t op_len = object_length(ops);
     std::size_t op_num_len = object_length(ops.size()) + 1;
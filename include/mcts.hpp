@@ -0,0 +1,624 @@
+/**
+ * @file mcts.hpp
+ * @author Yufei Li, Jingxuan Liu
+ * @brief Monte Carlo tree search, keeping its tree across rounds or growing it in parallel.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "simulate.hpp"
+#include "operation_set.hpp"
+
+/**
+ * @brief A move at the root of a search.
+ */
+struct MctsMove
+{
+    std::vector<Operation> operations;
+    int visits;
+    double value; ///< Mean reward of the move for the player to move, within [0, 1]
+};
+
+/**
+ * @brief Result of a Monte Carlo tree search.
+ */
+struct MctsResult
+{
+    std::vector<Operation> operations; ///< Operations of the most visited move at the root
+    std::vector<MctsMove> moves;       ///< Moves at the root, in the order of candidate_moves()
+    int iterations;                    ///< Iterations run by this search
+    int root_visits;                   ///< Visits of the root after the search, including reused ones
+    int reused_visits;                 ///< Visits of the root kept from earlier searches
+    std::size_t nodes;                 ///< Nodes in the tree after the search
+};
+
+/**
+ * @brief Monte Carlo tree search (UCT) over Simulator, reusing its tree from round to round.
+ *
+ * Rounds are searched as alternating moves, as in EndgameSolver: player 0 applies operations,
+ * player 1 applies operations after seeing them, and then the round is settled. Each move is
+ * doing nothing or one of a few operations picked from candidate_operations(). Leaves are scored
+ * by a short rollout where nobody acts.
+ *
+ * Nodes live in an arena and remember the hash of their state (GameInfo::hash() combined with
+ * the player to move). When a search starts from a new state, e.g. after Controller has applied
+ * get_opponent_operations() and read the round info, the tree is searched for the node of that
+ * state. If found, its subtree becomes the new tree and every other node goes back to the free
+ * list of the arena, so the visits spent on the actual line in earlier rounds are kept.
+ *
+ * @code
+ * MctsSearch mcts;
+ * // Every round, when it is time to decide
+ * MctsResult result = mcts.search(c.get_info(), c.self_player_id, 2000);
+ * for (auto& op: result.operations)
+ *     c.append_self_operation(op);
+ * @endcode
+ */
+class MctsSearch
+{
+public:
+    /**
+     * @brief Settings of a search.
+     */
+    struct Options
+    {
+        int max_nodes = 1 << 16;   ///< Capacity of the node arena. Leaves are not expanded when it is full.
+        int max_children = 8;      ///< Moves per node, including doing nothing
+        int rollout_rounds = 4;    ///< Rounds settled after a leaf before scoring it
+        double exploration = 0.7;  ///< UCT exploration constant
+    };
+
+private:
+    struct Node
+    {
+        std::uint64_t key;            ///< State hash combined with the player to move, or 0 if not reached yet
+        int parent;
+        int first_child;
+        int next_sibling;
+        int player;                   ///< Player to move
+        bool expanded;
+        int visits;
+        double value;                 ///< Sum of rewards for the player who moved into this node
+        std::vector<Operation> move;  ///< Operations leading here from the parent
+    };
+
+    Options options;
+    std::vector<Node> nodes;
+    std::vector<int> free_nodes;
+    int root = -1;
+
+    static std::uint64_t key_of(const GameInfo& info, int player)
+    {
+        return GameInfo::hash_combine(info.hash(), player);
+    }
+
+    /**
+     * @brief Take a node from the arena, or -1 if it is full.
+     */
+    int allocate(int parent, int player)
+    {
+        int index;
+        if (!free_nodes.empty())
+        {
+            index = free_nodes.back();
+            free_nodes.pop_back();
+        }
+        else if (static_cast<int>(nodes.size()) < options.max_nodes)
+        {
+            index = nodes.size();
+            nodes.emplace_back();
+        }
+        else
+            return -1;
+        Node& node = nodes[index];
+        node.key = 0;
+        node.parent = parent;
+        node.first_child = node.next_sibling = -1;
+        node.player = player;
+        node.expanded = false;
+        node.visits = 0;
+        node.value = 0;
+        node.move.clear();
+        return index;
+    }
+
+    /**
+     * @brief Return a subtree to the arena, except the subtree of "keep".
+     */
+    void release(int top, int keep)
+    {
+        std::vector<int> stack{top};
+        while (!stack.empty())
+        {
+            int index = stack.back();
+            stack.pop_back();
+            if (index == keep)
+                continue;
+            for (int child = nodes[index].first_child; child != -1; child = nodes[child].next_sibling)
+                stack.push_back(child);
+            free_nodes.push_back(index);
+        }
+    }
+
+    /**
+     * @brief Create the children of a node, or nothing if the arena is too full.
+     * @return Whether the node has been expanded.
+     */
+    bool expand(int index, const GameInfo& info)
+    {
+        int player = nodes[index].player;
+        std::vector<std::vector<Operation>> moves = candidate_moves(info, player, options.max_children);
+        if (static_cast<int>(free_nodes.size() + options.max_nodes - nodes.size()) < static_cast<int>(moves.size()))
+            return false;
+        // Link in reverse so that children keep the order of moves
+        for (int i = moves.size() - 1; i >= 0; --i)
+        {
+            int child = allocate(index, !player);
+            nodes[child].move = std::move(moves[i]);
+            nodes[child].next_sibling = nodes[index].first_child;
+            nodes[index].first_child = child;
+        }
+        nodes[index].expanded = true;
+        return true;
+    }
+
+    /**
+     * @brief Pick a child by UCT, unvisited children first.
+     */
+    int select(int index) const
+    {
+        double log_visits = std::log(static_cast<double>(nodes[index].visits));
+        int best = -1;
+        double best_score = -1;
+        for (int child = nodes[index].first_child; child != -1; child = nodes[child].next_sibling)
+        {
+            const Node& node = nodes[child];
+            if (node.visits == 0)
+                return child;
+            double score = node.value / node.visits + options.exploration * std::sqrt(log_visits / node.visits);
+            if (score > best_score)
+            {
+                best_score = score;
+                best = child;
+            }
+        }
+        return best;
+    }
+
+    /**
+     * @brief Run one iteration: select a path, expand its leaf, roll out and back up.
+     */
+    void iterate(Simulator& s)
+    {
+        int index = root;
+        GameState state = GameState::Running;
+        while (state == GameState::Running)
+        {
+            if (!nodes[index].expanded && !expand(index, s.get_info()))
+                break;
+            int child = select(index);
+            int player = nodes[index].player;
+            for (auto& op: nodes[child].move)
+                s.add_operation_of_player(player, op);
+            s.apply_operations_of_player(player);
+            if (player == 1)
+                state = s.next_round();
+            index = child;
+            if (nodes[index].key == 0)
+                nodes[index].key = key_of(s.get_info(), nodes[index].player);
+            if (nodes[index].visits == 0)
+                break;
+        }
+        // Nobody acts in the rollout
+        if (state == GameState::Running && nodes[index].player == 1)
+        {
+            s.apply_operations_of_player(1);
+            state = s.next_round();
+        }
+        for (int r = 0; r < options.rollout_rounds && state == GameState::Running; ++r)
+        {
+            s.apply_operations_of_player(0);
+            s.apply_operations_of_player(1);
+            state = s.next_round();
+        }
+        double result = reward(state, s.get_info());
+        for (; index != -1; index = nodes[index].parent)
+        {
+            ++nodes[index].visits;
+            nodes[index].value += nodes[index].player == 1 ? result : 1 - result;
+        }
+    }
+
+public:
+    MctsSearch() : MctsSearch(Options()) {}
+
+    explicit MctsSearch(const Options& options) : options(options) {}
+
+    /**
+     * @brief List the moves searched in a state: doing nothing, and single operations picked
+     * evenly from candidate_operations(), whose canonical order groups operations by kind.
+     * @param info The state.
+     * @param player The player to move.
+     * @param max_children Max number of moves.
+     */
+    static std::vector<std::vector<Operation>> candidate_moves(const GameInfo& info, int player, int max_children)
+    {
+        std::vector<Operation> ops = candidate_operations(info, player);
+        std::vector<std::vector<Operation>> moves(1);
+        int picks = std::min<int>(ops.size(), max_children - 1);
+        for (int i = 0; i < picks; ++i)
+            moves.push_back({ops[i * ops.size() / picks]});
+        return moves;
+    }
+
+    /**
+     * @brief Reward of a state for player 0, within [0, 1].
+     */
+    static double reward(GameState state, const GameInfo& info)
+    {
+        if (state == GameState::Player0Win)
+            return 1;
+        if (state == GameState::Player1Win)
+            return 0;
+        if (state == GameState::Undecided)
+            return 0.5;
+        double score = (info.bases[0].hp - info.bases[1].hp) * 1000.0 + info.coins[0] - info.coins[1];
+        return 1 / (1 + std::exp(-score / 500));
+    }
+
+    /**
+     * @brief Drop the whole tree, keeping the memory of the arena.
+     */
+    void clear()
+    {
+        if (root != -1)
+            release(root, -1);
+        root = -1;
+    }
+
+    /**
+     * @brief Get the number of nodes in the tree.
+     */
+    std::size_t size() const
+    {
+        return nodes.size() - free_nodes.size();
+    }
+
+    /**
+     * @brief Move the root to a new state, keeping its subtree if the tree has reached it.
+     * @param info The new state. If player 1 is to move, player 0 must have applied its
+     *        operations of this round, as in the game process of Controller.
+     * @param player The player to move.
+     * @return Whether a subtree has been kept.
+     * @note Called by search(), so there is no need to call it directly.
+     */
+    bool advance(const GameInfo& info, int player)
+    {
+        std::uint64_t key = key_of(info, player);
+        int found = -1;
+        if (root != -1)
+        {
+            // Breadth-first, so the shallowest match is kept
+            std::vector<int> queue{root};
+            for (std::size_t i = 0; i < queue.size() && found == -1; ++i)
+            {
+                const Node& node = nodes[queue[i]];
+                if (node.key == key && node.player == player)
+                    found = queue[i];
+                for (int child = node.first_child; child != -1; child = nodes[child].next_sibling)
+                    queue.push_back(child);
+            }
+        }
+        if (found == root && root != -1)
+            return true;
+        if (root != -1)
+            release(root, found);
+        if (found != -1)
+        {
+            root = found;
+            nodes[root].parent = -1;
+            nodes[root].next_sibling = -1;
+            nodes[root].move.clear();
+            return true;
+        }
+        root = allocate(-1, player);
+        nodes[root].key = key;
+        return false;
+    }
+
+    /**
+     * @brief Search a state, continuing from the tree of earlier searches if it has reached it.
+     * @param info Current game state. If player 1 is to move, player 0 must have applied its
+     *        operations of this round, as in the game process of Controller.
+     * @param player The player to move.
+     * @param iterations Number of iterations to run.
+     * @return The most visited move and statistics of the tree.
+     */
+    MctsResult search(const GameInfo& info, int player, int iterations)
+    {
+        if (nodes.capacity() == 0)
+            nodes.reserve(options.max_nodes);
+        advance(info, player);
+        MctsResult result{{}, {}, iterations, 0, nodes[root].visits, 0};
+        Simulator base(info), s(base);
+        for (int i = 0; i < iterations; ++i)
+        {
+            s.assign(base);
+            iterate(s);
+        }
+        int best = -1;
+        for (int child = nodes[root].first_child; child != -1; child = nodes[child].next_sibling)
+        {
+            const Node& node = nodes[child];
+            result.moves.push_back({node.move, node.visits, node.visits ? node.value / node.visits : 0});
+            if (best == -1 || node.visits > nodes[best].visits)
+                best = child;
+        }
+        if (best != -1)
+            result.operations = nodes[best].move;
+        result.root_visits = nodes[root].visits;
+        result.nodes = size();
+        return result;
+    }
+};
+
+/**
+ * @brief Tree-parallel Monte Carlo tree search: all threads grow one shared tree.
+ *
+ * Moves, rewards and rollouts are those of MctsSearch. Threads share the tree without locks:
+ * - Visit and value counters of nodes are atomic. A visit is counted when a thread selects a
+ *   node and its reward is added when the rollout is backed up, so a visit in flight counts as a
+ *   loss (virtual loss) and steers other threads to other lines meanwhile;
+ * - A leaf is expanded by the thread that moves it from Leaf to Expanding with compare-and-swap.
+ *   Children are taken as one block from a bump allocator and published by storing Expanded
+ *   with release order. Threads reaching a leaf being expanded roll out from it instead of waiting;
+ * - Each thread keeps its own Simulator, copied from the root with Simulator::assign() every
+ *   iteration.
+ *
+ * The tree is rebuilt by every search. Unlike MctsSearch, it is not kept across rounds, since
+ * freeing nodes would need the threads to agree on when nobody uses them.
+ *
+ * @code
+ * ParallelMctsSearch::Options options;
+ * options.threads = 4;
+ * ParallelMctsSearch mcts(options);
+ * MctsResult result = mcts.search(c.get_info(), c.self_player_id, 8000);
+ * @endcode
+ */
+class ParallelMctsSearch
+{
+public:
+    /**
+     * @brief Settings of a search.
+     */
+    struct Options
+    {
+        int max_nodes = 1 << 16;   ///< Capacity of the node arena. Leaves are not expanded when it is full.
+        int max_children = 8;      ///< Moves per node, including doing nothing
+        int rollout_rounds = 4;    ///< Rounds settled after a leaf before scoring it
+        double exploration = 0.7;  ///< UCT exploration constant
+        int threads = 0;           ///< Search threads, or 0 for one per hardware thread
+        int virtual_loss = 1;      ///< Losses counted for a visit in flight
+    };
+
+private:
+    enum NodeState : int
+    {
+        Leaf,
+        Expanding,
+        Expanded
+    };
+
+    struct Node
+    {
+        std::atomic<int> state;
+        std::atomic<int> visits;       ///< Including visits in flight
+        std::atomic<long long> value;  ///< Sum of rewards for the player who moved into this node, times VALUE_SCALE
+        int first_child;               ///< Children are contiguous. Set before state becomes Expanded.
+        int child_count;
+        int player;                    ///< Player to move
+        std::vector<Operation> move;   ///< Operations leading here from the parent
+    };
+
+    static constexpr double VALUE_SCALE = 1 << 20; ///< Fixed point scale of rewards in Node::value
+
+    Options options;
+    std::unique_ptr<Node[]> nodes;
+    std::atomic<int> used;
+
+    void reset(int index, int player)
+    {
+        Node& node = nodes[index];
+        node.state.store(Leaf, std::memory_order_relaxed);
+        node.visits.store(0, std::memory_order_relaxed);
+        node.value.store(0, std::memory_order_relaxed);
+        node.first_child = -1;
+        node.child_count = 0;
+        node.player = player;
+    }
+
+    /**
+     * @brief Create the children of a node owned by this thread in state Expanding.
+     * @return Whether the node has been expanded. If not, it stays Expanding, i.e. a leaf for good.
+     */
+    bool expand(int index, const GameInfo& info)
+    {
+        Node& node = nodes[index];
+        std::vector<std::vector<Operation>> moves = MctsSearch::candidate_moves(info, node.player, options.max_children);
+        int count = moves.size();
+        if (used.load(std::memory_order_relaxed) + count > options.max_nodes)
+            return false;
+        int first = used.fetch_add(count, std::memory_order_relaxed);
+        if (first + count > options.max_nodes)
+            return false;
+        for (int i = 0; i < count; ++i)
+        {
+            reset(first + i, !node.player);
+            nodes[first + i].move = std::move(moves[i]);
+        }
+        node.first_child = first;
+        node.child_count = count;
+        node.state.store(Expanded, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pick a child of an expanded node by UCT, unvisited children first.
+     */
+    int select(int index) const
+    {
+        const Node& node = nodes[index];
+        double log_visits = std::log(std::max(1, node.visits.load(std::memory_order_relaxed)));
+        int best = -1;
+        double best_score = -1;
+        for (int child = node.first_child; child < node.first_child + node.child_count; ++child)
+        {
+            int visits = nodes[child].visits.load(std::memory_order_relaxed);
+            if (visits == 0)
+                return child;
+            double mean = nodes[child].value.load(std::memory_order_relaxed) / VALUE_SCALE / visits;
+            double score = mean + options.exploration * std::sqrt(log_visits / visits);
+            if (score > best_score)
+            {
+                best_score = score;
+                best = child;
+            }
+        }
+        return best;
+    }
+
+    /**
+     * @brief Run one iteration: select a path, expand its leaf, roll out and back up.
+     */
+    void iterate(Simulator& s, std::vector<int>& path)
+    {
+        int index = 0;
+        path.assign(1, index);
+        nodes[index].visits.fetch_add(options.virtual_loss, std::memory_order_relaxed);
+        GameState state = GameState::Running;
+        while (state == GameState::Running)
+        {
+            int expected = Leaf;
+            int node_state = nodes[index].state.load(std::memory_order_acquire);
+            if (node_state == Leaf
+                && !(nodes[index].state.compare_exchange_strong(expected, Expanding, std::memory_order_acquire)
+                    && expand(index, s.get_info())))
+                break;
+            if (node_state == Expanding)
+                break;
+            int child = select(index);
+            int player = nodes[index].player;
+            for (auto& op: nodes[child].move)
+                s.add_operation_of_player(player, op);
+            s.apply_operations_of_player(player);
+            if (player == 1)
+                state = s.next_round();
+            index = child;
+            path.push_back(index);
+            if (nodes[index].visits.fetch_add(options.virtual_loss, std::memory_order_relaxed) == 0)
+                break;
+        }
+        // Nobody acts in the rollout
+        if (state == GameState::Running && nodes[index].player == 1)
+        {
+            s.apply_operations_of_player(1);
+            state = s.next_round();
+        }
+        for (int r = 0; r < options.rollout_rounds && state == GameState::Running; ++r)
+        {
+            s.apply_operations_of_player(0);
+            s.apply_operations_of_player(1);
+            state = s.next_round();
+        }
+        double result = MctsSearch::reward(state, s.get_info());
+        for (int i: path)
+        {
+            double reward = nodes[i].player == 1 ? result : 1 - result;
+            nodes[i].value.fetch_add(std::llround(reward * VALUE_SCALE), std::memory_order_relaxed);
+            if (options.virtual_loss != 1)
+                nodes[i].visits.fetch_sub(options.virtual_loss - 1, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    ParallelMctsSearch() : ParallelMctsSearch(Options()) {}
+
+    explicit ParallelMctsSearch(const Options& options)
+        : options(options), nodes(new Node[options.max_nodes]), used(0) {}
+
+    /**
+     * @brief Search a state.
+     * @param info Current game state. If player 1 is to move, player 0 must have applied its
+     *        operations of this round, as in the game process of Controller.
+     * @param player The player to move.
+     * @param iterations Number of iterations to run, shared among threads.
+     * @return The most visited move and statistics of the tree.
+     * @throw Whatever a simulation throws.
+     */
+    MctsResult search(const GameInfo& info, int player, int iterations)
+    {
+        used.store(1);
+        reset(0, player);
+        Simulator base(info);
+        std::atomic<int> next(0);
+        std::exception_ptr error;
+        std::atomic<bool> failed(false);
+        auto work = [&]
+        {
+            Simulator s(base);
+            std::vector<int> path;
+            while (next++ < iterations && !failed)
+            {
+                try
+                {
+                    s.assign(base);
+                    iterate(s, path);
+                }
+                catch (...)
+                {
+                    if (!failed.exchange(true))
+                        error = std::current_exception();
+                }
+            }
+        };
+        int threads = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+        threads = std::max(1, std::min(threads, iterations));
+        std::vector<std::thread> workers;
+        for (int t = 1; t < threads; ++t)
+            workers.emplace_back(work);
+        work();
+        for (auto& w: workers)
+            w.join();
+        if (error)
+            std::rethrow_exception(error);
+
+        MctsResult result{{}, {}, iterations, nodes[0].visits.load(), 0, static_cast<std::size_t>(std::min(used.load(), options.max_nodes))};
+        const Node& root = nodes[0];
+        int best = -1;
+        if (root.state.load(std::memory_order_acquire) == Expanded)
+            for (int child = root.first_child; child < root.first_child + root.child_count; ++child)
+            {
+                int visits = nodes[child].visits.load();
+                result.moves.push_back({nodes[child].move, visits, visits ? nodes[child].value.load() / VALUE_SCALE / visits : 0});
+                if (best == -1 || visits > nodes[best].visits.load())
+                    best = child;
+            }
+        if (best != -1)
+            result.operations = nodes[best].move;
+        return result;
+    }
+};
+
+constexpr double ParallelMctsSearch::VALUE_SCALE;
@@ -0,0 +1,126 @@
+/**
+ * @file memory.hpp
+ * @author Yufei Li, Jingxuan Liu
+ * @brief Optional counting allocator hook and process memory statistics.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * @note Define ANTWAR_COUNT_ALLOCATIONS before including this header in exactly one translation
+ * unit to replace global operator new and delete with counting versions. Otherwise only
+ * peak_rss() is available and allocation statistics stay zero.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+/**
+ * @brief Statistics of heap allocations through global operator new.
+ */
+struct AllocationStats
+{
+    std::atomic<std::size_t> current; ///< Bytes currently allocated
+    std::atomic<std::size_t> peak;    ///< Peak of "current" since last reset
+    std::atomic<std::size_t> count;   ///< Number of allocations ever made
+
+    /**
+     * @brief Get the global statistics.
+     */
+    static AllocationStats& instance()
+    {
+        static AllocationStats stats;
+        return stats;
+    }
+
+    /**
+     * @brief Restart peak tracking from current usage.
+     */
+    void reset_peak()
+    {
+        peak = current.load();
+    }
+
+    void on_allocate(std::size_t size)
+    {
+        std::size_t now = current.fetch_add(size, std::memory_order_relaxed) + size;
+        std::size_t old = peak.load(std::memory_order_relaxed);
+        while (now > old && !peak.compare_exchange_weak(old, now, std::memory_order_relaxed))
+            ;
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void on_deallocate(std::size_t size)
+    {
+        current.fetch_sub(size, std::memory_order_relaxed);
+    }
+
+private:
+    AllocationStats() : current(0), peak(0), count(0) {}
+};
+
+/**
+ * @brief Get the peak resident set size of the process.
+ * @return Peak RSS in KiB, or 0 if unsupported.
+ */
+inline std::size_t peak_rss()
+{
+#ifdef __linux__
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_maxrss; // KiB on Linux
+#endif
+    return 0;
+}
+
+#ifdef ANTWAR_COUNT_ALLOCATIONS
+
+// Each block is prefixed with its size, padded to keep the default alignment of operator new.
+static constexpr std::size_t ALLOCATION_HEADER = alignof(std::max_align_t);
+
+void* operator new(std::size_t size)
+{
+    void* block = std::malloc(size + ALLOCATION_HEADER);
+    if (!block)
+        throw std::bad_alloc();
+    *static_cast<std::size_t*>(block) = size;
+    AllocationStats::instance().on_allocate(size);
+    return static_cast<char*>(block) + ALLOCATION_HEADER;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (!ptr)
+        return;
+    void* block = static_cast<char*>(ptr) - ALLOCATION_HEADER;
+    AllocationStats::instance().on_deallocate(*static_cast<std::size_t*>(block));
+    std::free(block);
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+#endif
@@ -0,0 +1,330 @@
+/**
+ * @file operation_set.hpp
+ * @author Yufei Li, Jingxuan Liu
+ * @brief Canonical ordering, compact encoding and enumeration of operation sets.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * @note The operations of a player in a round form a set: the order in which they are applied
+ * only decides ids of new towers, the order of super weapons in GameInfo::super_weapons, and the
+ * coins spent when towers are both destroyed and built. Applying a set in canonical order fixes
+ * the former two, and is the cheapest for the latter (destroying first refunds more and makes
+ * building cheaper), so a search loses nothing by expanding each set once, in canonical order.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "game_info.hpp"
+
+/**
+ * @brief Kind of an encoded operation, in canonical order. Upgrades are told apart by branch
+ * (the last digit of the target type), so that an encoding does not depend on the current level.
+ */
+enum OperationKind
+{
+    NoOperation = 0,       ///< Empty slot of an encoded set
+    KindDowngradeTower,    ///< Payload: tower id
+    KindBuildTower,        ///< Payload: x * MAP_SIZE + y
+    KindUpgradeTower1,     ///< Payload: tower id
+    KindUpgradeTower2,     ///< Payload: tower id
+    KindUpgradeTower3,     ///< Payload: tower id
+    KindUseLightningStorm, ///< Payload: x * MAP_SIZE + y
+    KindUseEmpBlaster,     ///< Payload: x * MAP_SIZE + y
+    KindUseDeflector,      ///< Payload: x * MAP_SIZE + y
+    KindUseEmergencyEvasion, ///< Payload: x * MAP_SIZE + y
+    KindUpgradeGenerationSpeed, ///< No payload
+    KindUpgradeGeneratedAnt     ///< No payload
+};
+
+/**
+ * @brief Number of bits of an encoded operation, i.e. 4 bits of kind and 12 bits of payload.
+ */
+static constexpr int OPERATION_CODE_BITS = 16;
+
+/**
+ * @brief Max number of operations in a set with a 64-bit encoding.
+ */
+static constexpr int MAX_ENCODED_OPERATIONS = 64 / OPERATION_CODE_BITS;
+
+/**
+ * @brief Encode an operation into 16 bits.
+ * @param op The operation.
+ * @return The code, or nothing if the operation is malformed or its argument does not fit.
+ * Codes are ordered as operations are in canonical order.
+ */
+inline optional<std::uint16_t> encode_operation(const Operation& op)
+{
+    static constexpr int PAYLOAD_LIMIT = 1 << (OPERATION_CODE_BITS - 4);
+    int kind = NoOperation, payload = 0;
+    switch (op.type)
+    {
+        case BuildTower:
+        case UseLightningStorm:
+        case UseEmpBlaster:
+        case UseDeflector:
+        case UseEmergencyEvasion:
+            if (op.arg0 < 0 || op.arg0 >= MAP_SIZE || op.arg1 < 0 || op.arg1 >= MAP_SIZE)
+                return nullopt;
+            kind = op.type == BuildTower ? KindBuildTower : KindUseLightningStorm + (op.type - UseLightningStorm);
+            payload = op.arg0 * MAP_SIZE + op.arg1;
+            break;
+        case UpgradeTower:
+            if (op.arg1 % 10 < 1 || op.arg1 % 10 > 3)
+                return nullopt;
+            kind = KindUpgradeTower1 + op.arg1 % 10 - 1;
+            payload = op.arg0;
+            break;
+        case DowngradeTower:
+            kind = KindDowngradeTower;
+            payload = op.arg0;
+            break;
+        case UpgradeGenerationSpeed:
+            kind = KindUpgradeGenerationSpeed;
+            break;
+        case UpgradeGeneratedAnt:
+            kind = KindUpgradeGeneratedAnt;
+            break;
+        default:
+            return nullopt;
+    }
+    if (payload < 0 || payload >= PAYLOAD_LIMIT)
+        return nullopt;
+    return static_cast<std::uint16_t>(kind << (OPERATION_CODE_BITS - 4) | payload);
+}
+
+/**
+ * @brief Decode an operation.
+ * @param code The code from encode_operation().
+ * @param info Game state in which the operation is to be applied, for the target type of upgrades.
+ * @return The operation, or nothing if the code is malformed or refers to a missing tower.
+ */
+inline optional<Operation> decode_operation(std::uint16_t code, const GameInfo& info)
+{
+    int kind = code >> (OPERATION_CODE_BITS - 4), payload = code & ((1 << (OPERATION_CODE_BITS - 4)) - 1);
+    switch (kind)
+    {
+        case KindDowngradeTower:
+            return Operation(DowngradeTower, payload);
+        case KindBuildTower:
+            return Operation(BuildTower, payload / MAP_SIZE, payload % MAP_SIZE);
+        case KindUpgradeTower1:
+        case KindUpgradeTower2:
+        case KindUpgradeTower3:
+        {
+            auto tower = info.tower_of_id(payload);
+            if (!tower)
+                return nullopt;
+            int branch = kind - KindUpgradeTower1 + 1;
+            int type = tower.value().type == TowerType::Basic ? branch : tower.value().type * 10 + branch;
+            return Operation(UpgradeTower, payload, type);
+        }
+        case KindUseLightningStorm:
+        case KindUseEmpBlaster:
+        case KindUseDeflector:
+        case KindUseEmergencyEvasion:
+            return Operation(static_cast<OperationType>(UseLightningStorm + kind - KindUseLightningStorm),
+                payload / MAP_SIZE, payload % MAP_SIZE);
+        case KindUpgradeGenerationSpeed:
+            return Operation(UpgradeGenerationSpeed);
+        case KindUpgradeGeneratedAnt:
+            return Operation(UpgradeGeneratedAnt);
+        default:
+            return nullopt;
+    }
+}
+
+/**
+ * @brief Check if an operation comes before another in canonical order.
+ */
+inline bool canonical_less(const Operation& a, const Operation& b)
+{
+    auto ca = encode_operation(a), cb = encode_operation(b);
+    if (ca && cb)
+        return ca.value() < cb.value();
+    // Operations without a code are ordered last, by raw fields
+    if (ca || cb)
+        return static_cast<bool>(ca);
+    if (a.type != b.type)
+        return a.type < b.type;
+    return a.arg0 != b.arg0 ? a.arg0 < b.arg0 : a.arg1 < b.arg1;
+}
+
+/**
+ * @brief Sort an operation set into canonical order.
+ * @param ops The operation set.
+ */
+inline void canonicalize(std::vector<Operation>& ops)
+{
+    std::stable_sort(ops.begin(), ops.end(), canonical_less);
+}
+
+/**
+ * @brief Encode an operation set into 64 bits. Equal sets have equal codes, whatever their order.
+ * @param ops The operation set, in any order.
+ * @return The code, with codes of operations in canonical order from the highest 16 bits down and
+ * zeros in empty slots, or nothing if there are more than MAX_ENCODED_OPERATIONS operations or an
+ * operation cannot be encoded.
+ */
+inline optional<std::uint64_t> encode_operation_set(const std::vector<Operation>& ops)
+{
+    if (ops.size() > static_cast<std::size_t>(MAX_ENCODED_OPERATIONS))
+        return nullopt;
+    std::uint16_t codes[MAX_ENCODED_OPERATIONS] = {};
+    for (std::size_t i = 0; i < ops.size(); ++i)
+    {
+        auto code = encode_operation(ops[i]);
+        if (!code)
+            return nullopt;
+        codes[i] = code.value();
+    }
+    std::sort(codes, codes + ops.size());
+    std::uint64_t result = 0;
+    for (int i = 0; i < MAX_ENCODED_OPERATIONS; ++i)
+        result = result << OPERATION_CODE_BITS | codes[i];
+    return result;
+}
+
+/**
+ * @brief Decode an operation set.
+ * @param code The code from encode_operation_set().
+ * @param info Game state in which the operations are to be applied, see decode_operation().
+ * @return The operation set in canonical order, or nothing if the code is malformed.
+ */
+inline optional<std::vector<Operation>> decode_operation_set(std::uint64_t code, const GameInfo& info)
+{
+    std::vector<Operation> ops;
+    for (int i = MAX_ENCODED_OPERATIONS - 1; i >= 0; --i)
+    {
+        std::uint16_t c = code >> (i * OPERATION_CODE_BITS) & 0xffff;
+        if (c == 0)
+            continue;
+        auto op = decode_operation(c, info);
+        if (!op)
+            return nullopt;
+        ops.push_back(op.value());
+    }
+    return ops;
+}
+
+/**
+ * @brief List single operations worth considering for a player, each valid on its own, in
+ * canonical order: every build, upgrade, downgrade and base upgrade, and super weapons centered
+ * at ants (any other center is rarely better and would multiply the count by hundreds).
+ * @param info Current game state.
+ * @param player_id The player.
+ * @return The operations.
+ */
+inline std::vector<Operation> candidate_operations(const GameInfo& info, int player_id)
+{
+    std::vector<Operation> ops;
+    auto consider = [&](Operation op)
+    {
+        if (info.is_operation_valid(player_id, op) && info.check_affordable(player_id, {op}))
+            ops.push_back(op);
+    };
+    for (const Tower& tower: info.towers)
+    {
+        if (tower.player != player_id)
+            continue;
+        consider(Operation(DowngradeTower, tower.id));
+        int base = tower.type == TowerType::Basic ? 0 : tower.type * 10;
+        for (int branch = 1; branch <= 3; ++branch)
+            consider(Operation(UpgradeTower, tower.id, base + branch));
+    }
+    for (int x = 0; x < MAP_SIZE; ++x)
+        for (int y = 0; y < MAP_SIZE; ++y)
+            if (is_highland(player_id, x, y))
+                consider(Operation(BuildTower, x, y));
+    for (int type = UseLightningStorm; type <= UseEmergencyEvasion; ++type)
+        for (const Ant& ant: info.ants)
+            consider(Operation(static_cast<OperationType>(type), ant.x, ant.y));
+    consider(Operation(UpgradeGenerationSpeed));
+    consider(Operation(UpgradeGeneratedAnt));
+    canonicalize(ops);
+    // Ants sharing a cell give the same super weapon
+    ops.erase(std::unique(ops.begin(), ops.end(), [](const Operation& a, const Operation& b)
+    {
+        return a.type == b.type && a.arg0 == b.arg0 && a.arg1 == b.arg1;
+    }), ops.end());
+    return ops;
+}
+
+/**
+ * @brief Enumerate distinct valid operation sets of a player, each once and in canonical order.
+ *
+ * Sets are built from candidates in canonical order, and a set is extended only while
+ * GameInfo::is_operation_valid() accepts the next operation. This is exact pruning: every refund
+ * comes first in canonical order, so a set that cannot be afforded never becomes affordable by
+ * adding operations.
+ *
+ * @param info Current game state.
+ * @param player_id The player.
+ * @param candidates Operations to choose from, e.g. from candidate_operations(). They are
+ *        canonicalized and deduplicated first.
+ * @param max_size Max number of operations in a set.
+ * @param visit Callback taking each set as "const std::vector<Operation>&", starting with the empty
+ *        set. It returns false to stop the enumeration.
+ * @return Number of sets visited.
+ */
+template <typename F>
+long long enumerate_operation_sets(const GameInfo& info, int player_id, std::vector<Operation> candidates,
+                                   int max_size, F visit)
+{
+    canonicalize(candidates);
+    candidates.erase(std::unique(candidates.begin(), candidates.end(), [](const Operation& a, const Operation& b)
+    {
+        return a.type == b.type && a.arg0 == b.arg0 && a.arg1 == b.arg1;
+    }), candidates.end());
+
+    long long count = 0;
+    bool stopped = false;
+    std::vector<Operation> current;
+    // Depth-first over increasing candidate indexes
+    std::function<void(std::size_t)> extend = [&](std::size_t first)
+    {
+        ++count;
+        if (!visit(static_cast<const std::vector<Operation>&>(current)))
+        {
+            stopped = true;
+            return;
+        }
+        if (static_cast<int>(current.size()) >= max_size)
+            return;
+        for (std::size_t i = first; i < candidates.size() && !stopped; ++i)
+        {
+            if (!info.is_operation_valid(player_id, current, candidates[i]))
+                continue;
+            current.push_back(candidates[i]);
+            extend(i + 1);
+            current.pop_back();
+        }
+    };
+    extend(0);
+    return count;
+}
+
+/**
+ * @brief Collect distinct valid operation sets of a player, see enumerate_operation_sets().
+ * @param info Current game state.
+ * @param player_id The player.
+ * @param max_size Max number of operations in a set.
+ * @param limit Max number of sets to collect.
+ * @return The sets, starting with the empty set.
+ */
+inline std::vector<std::vector<Operation>> distinct_operation_sets(const GameInfo& info, int player_id,
+                                                                  int max_size, std::size_t limit = 1 << 16)
+{
+    std::vector<std::vector<Operation>> sets;
+    enumerate_operation_sets(info, player_id, candidate_operations(info, player_id), max_size,
+        [&](const std::vector<Operation>& ops)
+        {
+            sets.push_back(ops);
+            return sets.size() < limit;
+        });
+    return sets;
+}
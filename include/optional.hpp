@@ -1,5 +1,22 @@
 #pragma once
 
+// Use std::optional directly since C++17, skipping the optional-lite shim altogether
+#if __cplusplus >= 201703L
+
+#include <optional>
+
+template <typename T>
+using optional = std::optional<T>;
+
+using std::make_optional;
+
+using nullopt_t = std::nullopt_t;
+static constexpr nullopt_t nullopt = std::nullopt;
+
+using std::bad_optional_access;
+
+#else
+
 #include "optional-impl.hpp"
 
 template <typename T>
@@ -11,3 +28,5 @@ using nullopt_t = nonstd::nullopt_t;
 static constexpr nullopt_t nullopt = nonstd::nullopt;
 
 using nonstd::bad_optional_access;
+
+#endif
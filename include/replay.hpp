@@ -0,0 +1,712 @@
+/**
+ * @file replay.hpp
+ * @author Yufei Li, Jingxuan Liu
+ * @brief Compact replay archives: many games per file, delta-coded operations, random access.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "template.hpp"
+
+/**
+ * @brief Operations of both players in one round.
+ */
+struct ReplayRound
+{
+    std::vector<Operation> operations[2]; ///< Operations as returned by AIs, including invalid ones
+};
+
+/**
+ * @brief Everything needed to replay a game: seed, operations of each round and outcome.
+ */
+struct ReplayGame
+{
+    unsigned long long seed;
+    GameState state;                 ///< Final game state (never GameState::Running)
+    int base_hp[2];                  ///< Final hp of bases
+    std::vector<ReplayRound> rounds; ///< Operations of each round played
+};
+
+/**
+ * @brief Play a whole game between two AIs in-process, as play_game() does, and record it.
+ * @param ai0 AI callback of player 0.
+ * @param ai1 AI callback of player 1.
+ * @param seed Seed for pheromone initialization.
+ * @return The recorded game.
+ */
+inline ReplayGame record_game(AI ai0, AI ai1, unsigned long long seed)
+{
+    ReplayGame game{seed, GameState::Running, {0, 0}, {}};
+    AI recorders[2];
+    AI ais[2] = {ai0, ai1};
+    for (int player = 0; player < 2; ++player)
+        recorders[player] = [&, player](int id, const GameInfo& info)
+        {
+            std::vector<Operation> ops = ais[player](id, info);
+            // Player 0 acts first in each round
+            if (player == 0)
+                game.rounds.emplace_back();
+            game.rounds.back().operations[player] = ops;
+            return ops;
+        };
+    game.state = play_game(recorders[0], recorders[1], seed, [&game](const GameInfo& info)
+    {
+        game.base_hp[0] = info.bases[0].hp;
+        game.base_hp[1] = info.bases[1].hp;
+    });
+    return game;
+}
+
+/**
+ * @brief Varint coding of replay records.
+ *
+ * Unsigned integers are LEB128 varints (7 bits per byte, least significant first) and signed ones
+ * are zigzag-coded first, so that small deltas of either sign take one byte.
+ */
+class ReplayCoder
+{
+private:
+    const unsigned char* p = nullptr;
+    const unsigned char* end = nullptr;
+
+public:
+    /**
+     * @brief Start decoding a buffer.
+     */
+    ReplayCoder(const void* data, std::size_t size)
+        : p(static_cast<const unsigned char*>(data)), end(static_cast<const unsigned char*>(data) + size) {}
+
+    static void put(std::string& out, std::uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out += static_cast<char>(value | 0x80);
+            value >>= 7;
+        }
+        out += static_cast<char>(value);
+    }
+
+    static void put_signed(std::string& out, long long value)
+    {
+        put(out, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+    }
+
+    /**
+     * @brief Decode an unsigned integer.
+     * @throw std::runtime_error if the buffer ends first.
+     */
+    std::uint64_t get()
+    {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (p == end)
+                break;
+            unsigned char byte = *p++;
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+        throw std::runtime_error("malformed replay record");
+    }
+
+    long long get_signed()
+    {
+        std::uint64_t value = get();
+        return static_cast<long long>(value >> 1) ^ -static_cast<long long>(value & 1);
+    }
+
+    /**
+     * @brief Decode an unsigned integer that must be at most "limit".
+     */
+    int get_at_most(std::uint64_t limit)
+    {
+        std::uint64_t value = get();
+        if (value > limit)
+            throw std::runtime_error("malformed replay record");
+        return static_cast<int>(value);
+    }
+
+    /**
+     * @brief Take raw bytes.
+     */
+    const unsigned char* take(std::size_t size)
+    {
+        if (static_cast<std::size_t>(end - p) < size)
+            throw std::runtime_error("malformed replay record");
+        const unsigned char* data = p;
+        p += size;
+        return data;
+    }
+};
+
+/**
+ * @brief Layout of replay records, shared by ReplayWriter and ReplayReader.
+ *
+ * A game record is the seed, the outcome, the number of rounds, the keyframe interval and the
+ * operations. Operations are stored for non-empty rounds only, each preceded by the number of
+ * rounds skipped. An operation is its type and its arguments, each as the zigzag delta from the
+ * same argument of the previous operation of that type in the game, so that repeated builds and
+ * upgrades around the same places take a byte per argument.
+ *
+ * Keyframes, if any, follow: the full state at the beginning of every round that is a multiple of
+ * the interval (but 0), each preceded by its size, so that a state can be rebuilt from the latest
+ * keyframe before it rather than from the start. Pheromone is stored by bit pattern, so keyframes
+ * are exact.
+ */
+class ReplayFormat
+{
+private:
+    static constexpr int TYPE_LIMIT = UpgradeGeneratedAnt + 1;
+
+    /**
+     * @brief Get the number of arguments of an operation type.
+     */
+    static int arg_count(int type)
+    {
+        return type == UpgradeGeneratedAnt || type == UpgradeGenerationSpeed ? 0 : type == DowngradeTower ? 1 : 2;
+    }
+
+public:
+    static constexpr char MAGIC[9] = "ANTWARR1";       ///< Header of an archive
+    static constexpr char INDEX_MAGIC[9] = "ANTWARIX"; ///< End of the trailer after the index
+
+    /**
+     * @brief Previous arguments of each operation type, which arguments are delta-coded against.
+     */
+    struct Deltas
+    {
+        int last[TYPE_LIMIT][2] = {};
+    };
+
+    static void put_operations(std::string& out, const std::vector<Operation>& ops, Deltas& deltas)
+    {
+        ReplayCoder::put(out, ops.size());
+        for (auto& op: ops)
+        {
+            int type = op.type;
+            ReplayCoder::put(out, static_cast<unsigned>(type));
+            if (type < 0 || type >= TYPE_LIMIT)
+                continue;
+            int args[2] = {op.arg0, op.arg1};
+            for (int k = 0; k < arg_count(type); ++k)
+            {
+                ReplayCoder::put_signed(out, static_cast<long long>(args[k]) - deltas.last[type][k]);
+                deltas.last[type][k] = args[k];
+            }
+        }
+    }
+
+    static std::vector<Operation> get_operations(ReplayCoder& in, Deltas& deltas)
+    {
+        std::vector<Operation> ops;
+        int count = in.get_at_most(1 << 16);
+        ops.reserve(count);
+        for (int i = 0; i < count; ++i)
+        {
+            int type = static_cast<int>(in.get());
+            int args[2] = {Operation::INVALID_ARG, Operation::INVALID_ARG};
+            if (type >= 0 && type < TYPE_LIMIT)
+                for (int k = 0; k < arg_count(type); ++k)
+                    args[k] = deltas.last[type][k] = static_cast<int>(deltas.last[type][k] + in.get_signed());
+            ops.emplace_back(static_cast<OperationType>(type), args[0], args[1]);
+        }
+        return ops;
+    }
+
+    /**
+     * @brief Encode the full state of a game.
+     */
+    static void put_state(std::string& out, const GameInfo& info)
+    {
+        using C = ReplayCoder;
+        C::put(out, info.round);
+        C::put(out, info.next_ant_id);
+        C::put(out, info.next_tower_id);
+        for (int player = 0; player < 2; ++player)
+        {
+            C::put(out, info.coins[player]);
+            C::put_signed(out, info.bases[player].hp);
+            C::put(out, info.bases[player].gen_speed_level);
+            C::put(out, info.bases[player].ant_level);
+            for (int type = 0; type < SuperWeaponCount; ++type)
+                C::put_signed(out, info.super_weapon_cd[player][type]);
+        }
+        C::put(out, info.towers.size());
+        for (auto& t: info.towers)
+        {
+            C::put(out, t.id);
+            C::put(out, t.player);
+            C::put(out, t.x);
+            C::put(out, t.y);
+            C::put(out, t.type);
+            C::put_signed(out, t.cd);
+        }
+        C::put(out, info.ants.size());
+        for (auto& a: info.ants)
+        {
+            C::put(out, a.id);
+            C::put(out, a.player);
+            C::put(out, a.x);
+            C::put(out, a.y);
+            C::put_signed(out, a.hp);
+            C::put(out, a.level);
+            C::put(out, a.age);
+            C::put(out, a.state);
+            C::put_signed(out, a.evasion);
+            C::put(out, a.deflector);
+            C::put(out, a.path.size());
+            for (int d: a.path)
+                C::put(out, d);
+        }
+        C::put(out, info.super_weapons.size());
+        for (auto& w: info.super_weapons)
+        {
+            C::put(out, w.type);
+            C::put(out, w.player);
+            C::put(out, w.x);
+            C::put(out, w.y);
+            C::put_signed(out, w.left_time);
+        }
+        out.append(reinterpret_cast<const char*>(&info.pheromone[0][0][0]), sizeof(info.pheromone));
+    }
+
+    /**
+     * @brief Decode a full state into "info", which must have been constructed with the seed of the game.
+     */
+    static void get_state(ReplayCoder& in, GameInfo& info)
+    {
+        const int limit = 1 << 20;
+        info.round = in.get_at_most(MAX_ROUND);
+        info.next_ant_id = in.get_at_most(limit);
+        info.next_tower_id = in.get_at_most(limit);
+        for (int player = 0; player < 2; ++player)
+        {
+            info.coins[player] = in.get_at_most(limit);
+            info.bases[player].hp = static_cast<int>(in.get_signed());
+            info.bases[player].gen_speed_level = in.get_at_most(2);
+            info.bases[player].ant_level = in.get_at_most(2);
+            for (int type = 0; type < SuperWeaponCount; ++type)
+                info.super_weapon_cd[player][type] = static_cast<int>(in.get_signed());
+        }
+        info.towers.clear();
+        for (int i = 0, n = in.get_at_most(limit); i < n; ++i)
+        {
+            int id = in.get_at_most(limit), player = in.get_at_most(1), x = in.get_at_most(MAP_SIZE),
+                y = in.get_at_most(MAP_SIZE), type = in.get_at_most(limit);
+            info.towers.emplace_back(id, player, x, y, static_cast<TowerType>(type));
+            // Set apart from construction, which takes a cd of -1 for the maximum
+            info.towers.back().cd = static_cast<int>(in.get_signed());
+        }
+        info.ants.clear();
+        for (int i = 0, n = in.get_at_most(limit); i < n; ++i)
+        {
+            int id = in.get_at_most(limit), player = in.get_at_most(1), x = in.get_at_most(MAP_SIZE),
+                y = in.get_at_most(MAP_SIZE), hp = static_cast<int>(in.get_signed()), level = in.get_at_most(2),
+                age = in.get_at_most(limit), state = in.get_at_most(limit);
+            info.ants.emplace_back(id, player, x, y, hp, level, age, static_cast<AntState>(state));
+            Ant& a = info.ants.back();
+            a.evasion = static_cast<int>(in.get_signed());
+            a.deflector = in.get_at_most(1);
+            a.path.resize(in.get_at_most(limit));
+            for (int& d: a.path)
+                d = in.get_at_most(limit);
+        }
+        info.super_weapons.clear();
+        for (int i = 0, n = in.get_at_most(limit); i < n; ++i)
+        {
+            int type = in.get_at_most(SuperWeaponCount - 1);
+            if (type == 0)
+                throw std::runtime_error("malformed replay record");
+            int player = in.get_at_most(1), x = in.get_at_most(MAP_SIZE), y = in.get_at_most(MAP_SIZE);
+            info.super_weapons.emplace_back(static_cast<SuperWeaponType>(type), player, x, y);
+            info.super_weapons.back().left_time = static_cast<int>(in.get_signed());
+        }
+        std::memcpy(&info.pheromone[0][0][0], in.take(sizeof(info.pheromone)), sizeof(info.pheromone));
+    }
+
+    /**
+     * @brief Encode a game record.
+     * @param game The game.
+     * @param keyframe_interval Rounds between keyframes, or 0 for none. Keyframes are made by
+     *        replaying the game.
+     */
+    static std::string encode(const ReplayGame& game, int keyframe_interval)
+    {
+        std::string out;
+        ReplayCoder::put(out, game.seed);
+        ReplayCoder::put(out, game.state);
+        ReplayCoder::put_signed(out, game.base_hp[0]);
+        ReplayCoder::put_signed(out, game.base_hp[1]);
+        ReplayCoder::put(out, game.rounds.size());
+        ReplayCoder::put(out, keyframe_interval);
+        // Non-empty rounds, each after the number of rounds skipped since the previous one
+        std::size_t non_empty = 0;
+        for (auto& r: game.rounds)
+            non_empty += !r.operations[0].empty() || !r.operations[1].empty();
+        ReplayCoder::put(out, non_empty);
+        Deltas deltas;
+        std::size_t next = 0;
+        for (std::size_t i = 0; i < game.rounds.size(); ++i)
+        {
+            const ReplayRound& r = game.rounds[i];
+            if (r.operations[0].empty() && r.operations[1].empty())
+                continue;
+            ReplayCoder::put(out, i - next);
+            put_operations(out, r.operations[0], deltas);
+            put_operations(out, r.operations[1], deltas);
+            next = i + 1;
+        }
+        if (keyframe_interval > 0)
+        {
+            Simulator s(GameInfo{game.seed});
+            for (std::size_t i = 0; i < game.rounds.size(); ++i)
+            {
+                if (i > 0 && i % keyframe_interval == 0)
+                {
+                    std::string keyframe;
+                    put_state(keyframe, s.get_info());
+                    ReplayCoder::put(out, keyframe.size());
+                    out += keyframe;
+                }
+                if (replay_round(s, game.rounds[i]) != GameState::Running)
+                    break;
+            }
+        }
+        return out;
+    }
+
+    /**
+     * @brief Play one recorded round on a simulator, as play_game() does.
+     * @return Game state after the round.
+     */
+    static GameState replay_round(Simulator& s, const ReplayRound& round)
+    {
+        for (int player = 0; player < 2; ++player)
+        {
+            for (auto& op: round.operations[player])
+                s.add_operation_of_player(player, op);
+            s.apply_operations_of_player(player);
+        }
+        return s.next_round();
+    }
+
+    /**
+     * @brief Decode a game record up to its keyframes.
+     * @param in Decoder of the record, left at the keyframes.
+     * @param keyframe_interval Result: rounds between keyframes, or 0 for none.
+     */
+    static ReplayGame decode(ReplayCoder& in, int& keyframe_interval)
+    {
+        ReplayGame game;
+        game.seed = in.get();
+        game.state = static_cast<GameState>(in.get_at_most(GameState::Undecided));
+        game.base_hp[0] = static_cast<int>(in.get_signed());
+        game.base_hp[1] = static_cast<int>(in.get_signed());
+        game.rounds.resize(in.get_at_most(MAX_ROUND + 1));
+        keyframe_interval = in.get_at_most(MAX_ROUND + 1);
+        Deltas deltas;
+        std::size_t next = 0;
+        for (int i = 0, n = in.get_at_most(game.rounds.size()); i < n; ++i)
+        {
+            next += in.get_at_most(game.rounds.size());
+            if (next >= game.rounds.size())
+                throw std::runtime_error("malformed replay record");
+            for (int player = 0; player < 2; ++player)
+                game.rounds[next].operations[player] = get_operations(in, deltas);
+            ++next;
+        }
+        return game;
+    }
+};
+
+constexpr int ReplayFormat::TYPE_LIMIT;
+constexpr char ReplayFormat::MAGIC[9];
+constexpr char ReplayFormat::INDEX_MAGIC[9];
+
+/**
+ * @brief Append-only writer of replay archives, safe to use from multiple threads.
+ *
+ * An archive is a header, game records each preceded by its varint size, and, once the writer is
+ * closed, an index of record offsets (as varint deltas) with a fixed-size trailer pointing to it.
+ * Records are encoded by the calling thread, and only written under a lock. A game id is its
+ * position in the archive. An archive whose writer never closed has no index, and its readers
+ * rebuild it by scanning records.
+ *
+ * @code
+ * ReplayWriter writer("games.replay");
+ * writer.append(record_game(ai, ai, seed));
+ * @endcode
+ */
+class ReplayWriter
+{
+private:
+    std::FILE* file = nullptr;
+    std::uint64_t offset = 0;             ///< Size of the archive so far
+    std::vector<std::uint64_t> offsets;   ///< Offset of each record
+    int keyframe_interval;
+    std::mutex mutex;
+
+public:
+    /**
+     * @brief Create an archive, replacing any file at "path".
+     * @param path Path of the archive.
+     * @param keyframe_interval Rounds between keyframes of each game, or 0 for none. Keyframes
+     *        speed up ReplayReader::state() at the cost of size and of replaying games to append them.
+     * @throw std::runtime_error if the file cannot be created.
+     */
+    explicit ReplayWriter(const std::string& path, int keyframe_interval = 0) : keyframe_interval(keyframe_interval)
+    {
+        file = std::fopen(path.c_str(), "wb");
+        if (!file || std::fwrite(ReplayFormat::MAGIC, 1, 8, file) != 8)
+            throw std::runtime_error("cannot create replay archive " + path);
+        offset = 8;
+    }
+
+    ReplayWriter(const ReplayWriter&) = delete;
+    ReplayWriter& operator=(const ReplayWriter&) = delete;
+
+    ~ReplayWriter()
+    {
+        close();
+    }
+
+    /**
+     * @brief Append a game.
+     * @return Id of the game in the archive.
+     * @throw std::runtime_error if the writer is closed or the file cannot be written.
+     */
+    std::size_t append(const ReplayGame& game)
+    {
+        std::string payload = ReplayFormat::encode(game, keyframe_interval);
+        std::string record;
+        ReplayCoder::put(record, payload.size());
+        record += payload;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!file || std::fwrite(record.data(), 1, record.size(), file) != record.size())
+            throw std::runtime_error("cannot write replay archive");
+        offsets.push_back(offset);
+        offset += record.size();
+        return offsets.size() - 1;
+    }
+
+    /**
+     * @brief Get the number of games appended.
+     */
+    std::size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return offsets.size();
+    }
+
+    /**
+     * @brief Write the index and close the archive. Nothing can be appended afterwards.
+     * @return Whether everything has been written.
+     */
+    bool close()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!file)
+            return false;
+        std::string index;
+        ReplayCoder::put(index, offsets.size());
+        std::uint64_t previous = 8;
+        for (std::uint64_t o: offsets)
+        {
+            ReplayCoder::put(index, o - previous);
+            previous = o;
+        }
+        // Trailer: little-endian offset of the index, then the magic
+        for (int i = 0; i < 8; ++i)
+            index += static_cast<char>(offset >> (8 * i));
+        index.append(ReplayFormat::INDEX_MAGIC, 8);
+        bool ok = std::fwrite(index.data(), 1, index.size(), file) == index.size();
+        ok = std::fclose(file) == 0 && ok;
+        file = nullptr;
+        return ok;
+    }
+};
+
+/**
+ * @brief Reader of replay archives with random access by game id and round.
+ * @note A reader is not safe to share between threads. Open one per thread instead.
+ */
+class ReplayReader
+{
+private:
+    mutable std::ifstream file;
+    std::vector<std::uint64_t> offsets; ///< Offset of each record
+    mutable std::string buffer;
+
+    /**
+     * @brief Read a varint directly from the file.
+     * @return Whether a complete varint has been read.
+     */
+    bool read_varint(std::uint64_t& value) const
+    {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            int byte = file.get();
+            if (byte == EOF)
+                return false;
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Load the index written by ReplayWriter::close().
+     * @return Whether there is a valid index.
+     */
+    bool load_index(std::uint64_t size)
+    {
+        if (size < 24)
+            return false;
+        char trailer[16];
+        file.seekg(size - 16);
+        if (!file.read(trailer, 16) || std::memcmp(trailer + 8, ReplayFormat::INDEX_MAGIC, 8) != 0)
+            return false;
+        std::uint64_t index_offset = 0;
+        for (int i = 0; i < 8; ++i)
+            index_offset |= static_cast<std::uint64_t>(static_cast<unsigned char>(trailer[i])) << (8 * i);
+        if (index_offset < 8 || index_offset > size - 16)
+            return false;
+        std::string index(size - 16 - index_offset, '\0');
+        file.seekg(index_offset);
+        if (!file.read(&index[0], index.size()))
+            return false;
+        ReplayCoder in(index.data(), index.size());
+        std::uint64_t count = in.get(), o = 8;
+        if (count > index.size())
+            return false;
+        offsets.resize(count);
+        for (auto& entry: offsets)
+            entry = o += in.get();
+        return true;
+    }
+
+    /**
+     * @brief Read the record of a game into the buffer.
+     */
+    ReplayCoder read_record(std::size_t id) const
+    {
+        if (id >= offsets.size())
+            throw std::out_of_range("no such game in replay archive");
+        file.clear();
+        file.seekg(offsets[id]);
+        std::uint64_t size;
+        if (!read_varint(size) || size > (1 << 26))
+            throw std::runtime_error("malformed replay record");
+        buffer.resize(size);
+        if (!file.read(&buffer[0], size))
+            throw std::runtime_error("malformed replay record");
+        return ReplayCoder(buffer.data(), buffer.size());
+    }
+
+public:
+    /**
+     * @brief Open an archive.
+     * @param path Path of the archive.
+     * @throw std::runtime_error if the file cannot be read or is not an archive.
+     */
+    explicit ReplayReader(const std::string& path) : file(path, std::ios::binary)
+    {
+        char magic[8];
+        if (!file.read(magic, 8) || std::memcmp(magic, ReplayFormat::MAGIC, 8) != 0)
+            throw std::runtime_error("not a replay archive: " + path);
+        file.seekg(0, std::ios::end);
+        std::uint64_t size = file.tellg();
+        file.clear();
+        if (load_index(size))
+            return;
+        // No index, e.g. the writer did not close: scan complete records
+        offsets.clear();
+        file.clear();
+        std::uint64_t o = 8, record;
+        file.seekg(o);
+        while (read_varint(record))
+        {
+            std::uint64_t end = static_cast<std::uint64_t>(file.tellg()) + record;
+            if (end > size)
+                break;
+            offsets.push_back(o);
+            o = end;
+            file.seekg(o);
+        }
+        file.clear();
+    }
+
+    /**
+     * @brief Get the number of games in the archive.
+     */
+    std::size_t size() const
+    {
+        return offsets.size();
+    }
+
+    /**
+     * @brief Decode a game.
+     * @param id Id of the game.
+     * @throw std::out_of_range if there is no such game.
+     * @throw std::runtime_error if its record is malformed.
+     */
+    ReplayGame game(std::size_t id) const
+    {
+        ReplayCoder in = read_record(id);
+        int keyframe_interval;
+        return ReplayFormat::decode(in, keyframe_interval);
+    }
+
+    /**
+     * @brief Rebuild the state of a game at the beginning of a round, from the latest keyframe
+     *        before it if there are keyframes, or else from the start.
+     * @param id Id of the game.
+     * @param round Round, at most the number of rounds played.
+     * @return The state, as GameInfo::get_info() of a Simulator would give it.
+     * @throw std::out_of_range if there is no such game or round.
+     * @throw std::runtime_error if its record is malformed.
+     */
+    GameInfo state(std::size_t id, int round) const
+    {
+        ReplayCoder in = read_record(id);
+        int interval;
+        ReplayGame game = ReplayFormat::decode(in, interval);
+        if (round < 0 || round > static_cast<int>(game.rounds.size()))
+            throw std::out_of_range("no such round in replay archive");
+        GameInfo info(game.seed);
+        int from = 0;
+        // Keyframes are at multiples of the interval. Skip those before the latest one needed.
+        int rounds = static_cast<int>(game.rounds.size());
+        for (int r = interval; interval > 0 && r <= round && r < rounds; r += interval)
+        {
+            std::size_t size = in.get_at_most(1 << 26);
+            if (r + interval <= round && r + interval < rounds)
+            {
+                in.take(size);
+                continue;
+            }
+            ReplayCoder keyframe(in.take(size), size);
+            ReplayFormat::get_state(keyframe, info);
+            from = r;
+        }
+        Simulator s(info);
+        for (int r = from; r < round; ++r)
+            ReplayFormat::replay_round(s, game.rounds[r]);
+        return s.get_info();
+    }
+};
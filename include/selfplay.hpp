@@ -0,0 +1,524 @@
+/**
+ * @file selfplay.hpp
+ * @author Yufei Li, Jingxuan Liu
+ * @brief Self-play across processes and machines: a coordinator hands out seeds over TCP to workers.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#ifdef __linux__
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "template.hpp"
+
+/**
+ * @brief Games between two AIs of workers, by name, with consecutive seeds.
+ */
+struct SelfPlayMatch
+{
+    std::string ai0;                  ///< Name of the AI of player 0
+    std::string ai1;                  ///< Name of the AI of player 1
+    unsigned long long first_seed;    ///< Seed of the first game. Game i uses first_seed + i.
+    int games;
+};
+
+/**
+ * @brief Result of one self-play game, as sent back by a worker.
+ */
+struct SelfPlayGame
+{
+    GameState state; ///< Final game state (never GameState::Running)
+    int rounds;      ///< Round at the end of the game
+    int base_hp[2];
+};
+
+/**
+ * @brief Result of SelfPlayCoordinator::run().
+ */
+struct SelfPlayReport
+{
+    std::vector<std::vector<SelfPlayGame>> games; ///< Games of each match, in seed order
+    int workers;                                  ///< Workers connected at the end
+    int requeued;                                 ///< Batches played again after their worker was lost
+};
+
+/**
+ * @brief Wire format shared by SelfPlayCoordinator and SelfPlayWorker.
+ *
+ * Integers are 4-byte big-endian. A batch from the coordinator is kind (1), batch id, seed (high
+ * and low halves), count and the two AI names, each as length and bytes, and kind 0 ends the work of
+ * a worker. A reply is batch id and count followed by 5 bytes per game: state, rounds (2 bytes) and
+ * the hp of both bases as signed bytes. A count of 0 tells that the worker does not know one of the
+ * AIs.
+ */
+class SelfPlayWire
+{
+public:
+    static constexpr int GAME_BYTES = 5;
+    static constexpr std::uint32_t END = 0;
+    static constexpr std::uint32_t BATCH = 1;
+
+    static void append_u32(std::string& out, std::uint32_t value)
+    {
+        char buf[4] = {char(value >> 24), char(value >> 16), char(value >> 8), char(value)};
+        out.append(buf, 4);
+    }
+
+    static std::uint32_t get_u32(const char* p)
+    {
+        const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+        return std::uint32_t(u[0]) << 24 | u[1] << 16 | u[2] << 8 | u[3];
+    }
+
+    /**
+     * @brief Send all of "data".
+     * @return Whether it has been sent. A closed peer shows up as failure rather than SIGPIPE.
+     */
+    static bool send_all(int fd, const std::string& data)
+    {
+        std::size_t sent = 0;
+        while (sent < data.size())
+        {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            sent += n;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Receive exactly "size" bytes, blocking.
+     * @return Whether they have been received before the peer closed.
+     */
+    static bool recv_all(int fd, char* buf, std::size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t n = recv(fd, buf, size, 0);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            buf += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    static bool recv_u32(int fd, std::uint32_t& value)
+    {
+        char buf[4];
+        if (!recv_all(fd, buf, 4))
+            return false;
+        value = get_u32(buf);
+        return true;
+    }
+
+    static void set_no_delay(int fd)
+    {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+};
+
+constexpr int SelfPlayWire::GAME_BYTES;
+constexpr std::uint32_t SelfPlayWire::END;
+constexpr std::uint32_t SelfPlayWire::BATCH;
+
+/**
+ * @brief Worker of distributed self-play: plays batches of in-process games with its named AIs.
+ *
+ * @code
+ * SelfPlayWorker worker({{"new", new_ai}, {"old", old_ai}});
+ * worker.run("10.0.0.1", 7000);
+ * @endcode
+ */
+class SelfPlayWorker
+{
+public:
+    using Registry = std::vector<std::pair<std::string, AI>>;
+
+private:
+    Registry ais;
+
+    const AI* find(const std::string& name) const
+    {
+        for (auto& entry: ais)
+            if (entry.first == name)
+                return &entry.second;
+        return nullptr;
+    }
+
+    static bool recv_string(int fd, std::string& s)
+    {
+        std::uint32_t size;
+        if (!SelfPlayWire::recv_u32(fd, size) || size > 4096)
+            return false;
+        s.resize(size);
+        return size == 0 || SelfPlayWire::recv_all(fd, &s[0], size);
+    }
+
+    /**
+     * @brief Connect to a coordinator.
+     * @return The socket, or -1 on failure.
+     */
+    static int connect_to(const std::string& host, int port)
+    {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* addresses = nullptr;
+        if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0)
+            return -1;
+        int fd = -1;
+        for (addrinfo* a = addresses; a && fd == -1; a = a->ai_next)
+        {
+            fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+            if (fd != -1 && connect(fd, a->ai_addr, a->ai_addrlen) != 0)
+            {
+                close(fd);
+                fd = -1;
+            }
+        }
+        freeaddrinfo(addresses);
+        return fd;
+    }
+
+public:
+    /**
+     * @brief Construct a worker with the AIs it can play, by name.
+     */
+    explicit SelfPlayWorker(Registry ais) : ais(std::move(ais)) {}
+
+    /**
+     * @brief Connect to a coordinator and play batches until it ends the work.
+     * @param host Host name or address of the coordinator.
+     * @param port Port of the coordinator.
+     * @return Number of games played.
+     * @throw std::runtime_error if the coordinator cannot be reached or the connection is lost.
+     * @throw Whatever an AI throws.
+     */
+    long long run(const std::string& host, int port) const
+    {
+        int fd = connect_to(host, port);
+        if (fd == -1)
+            throw std::runtime_error("cannot connect to self-play coordinator");
+        SelfPlayWire::set_no_delay(fd);
+        long long played = 0;
+        std::string name0, name1, reply;
+        while (true)
+        {
+            std::uint32_t kind, id, seed_high, seed_low, count;
+            bool ok = SelfPlayWire::recv_u32(fd, kind);
+            if (ok && kind == SelfPlayWire::END)
+                break;
+            ok = ok && kind == SelfPlayWire::BATCH && SelfPlayWire::recv_u32(fd, id) &&
+                 SelfPlayWire::recv_u32(fd, seed_high) && SelfPlayWire::recv_u32(fd, seed_low) &&
+                 SelfPlayWire::recv_u32(fd, count) && recv_string(fd, name0) && recv_string(fd, name1);
+            if (!ok)
+            {
+                close(fd);
+                throw std::runtime_error("connection to self-play coordinator lost");
+            }
+            const AI* ai0 = find(name0);
+            const AI* ai1 = find(name1);
+            if (!ai0 || !ai1)
+                count = 0;
+            reply.clear();
+            SelfPlayWire::append_u32(reply, id);
+            SelfPlayWire::append_u32(reply, count);
+            unsigned long long seed = static_cast<unsigned long long>(seed_high) << 32 | seed_low;
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                char game[SelfPlayWire::GAME_BYTES];
+                try
+                {
+                    game[0] = play_game(*ai0, *ai1, seed + i, [&game](const GameInfo& info)
+                    {
+                        game[1] = char(info.round >> 8);
+                        game[2] = char(info.round);
+                        game[3] = char(info.bases[0].hp);
+                        game[4] = char(info.bases[1].hp);
+                    });
+                }
+                catch (...)
+                {
+                    close(fd);
+                    throw;
+                }
+                reply.append(game, sizeof(game));
+            }
+            played += count;
+            if (!SelfPlayWire::send_all(fd, reply))
+            {
+                close(fd);
+                throw std::runtime_error("connection to self-play coordinator lost");
+            }
+        }
+        close(fd);
+        return played;
+    }
+};
+
+/**
+ * @brief Coordinator of distributed self-play over TCP.
+ *
+ * Workers (SelfPlayWorker, any number, on any machine) connect to the coordinator, which splits
+ * matches into batches of seeds and keeps a few batches in flight per worker, so that workers never
+ * wait for it and throughput grows with workers. Workers join at any time and stay connected across
+ * runs until the coordinator is destroyed. The batches of a worker that is lost are played again by
+ * others. Games are in-process on workers, so results only depend on seeds and AIs.
+ *
+ * @code
+ * SelfPlayCoordinator coordinator;
+ * coordinator.listen();
+ * // Start workers connecting to coordinator.port()
+ * SelfPlayReport report = coordinator.run({{"new", "old", 1, 1000}, {"old", "new", 1, 1000}});
+ * @endcode
+ */
+class SelfPlayCoordinator
+{
+public:
+    /**
+     * @brief Where to listen and how to split work.
+     */
+    struct Options
+    {
+        std::string address = "127.0.0.1"; ///< Address to listen on, e.g. "0.0.0.0" for workers on other machines
+        int port = 0;                      ///< Port to listen on, or 0 for any free port
+        int batch_games = 16;              ///< Games per batch
+        int batches_ahead = 2;             ///< Batches in flight per worker
+    };
+
+private:
+    struct Batch
+    {
+        int match;
+        int first; ///< Index of the first game within the match
+        int count;
+    };
+
+    struct Worker
+    {
+        int fd;
+        std::string input;         ///< Bytes received but not handled yet
+        std::deque<int> in_flight; ///< Batches sent, in order
+    };
+
+    Options options;
+    int listener = -1;
+    int bound_port = 0;
+    std::vector<Worker> workers;
+
+    static std::string batch_message(int id, const SelfPlayMatch& match, const Batch& batch)
+    {
+        std::string out;
+        SelfPlayWire::append_u32(out, SelfPlayWire::BATCH);
+        SelfPlayWire::append_u32(out, id);
+        unsigned long long seed = match.first_seed + batch.first;
+        SelfPlayWire::append_u32(out, static_cast<std::uint32_t>(seed >> 32));
+        SelfPlayWire::append_u32(out, static_cast<std::uint32_t>(seed));
+        SelfPlayWire::append_u32(out, batch.count);
+        for (const std::string* name: {&match.ai0, &match.ai1})
+        {
+            SelfPlayWire::append_u32(out, name->size());
+            out += *name;
+        }
+        return out;
+    }
+
+public:
+    SelfPlayCoordinator() : SelfPlayCoordinator(Options()) {}
+
+    explicit SelfPlayCoordinator(const Options& options) : options(options) {}
+
+    SelfPlayCoordinator(const SelfPlayCoordinator&) = delete;
+    SelfPlayCoordinator& operator=(const SelfPlayCoordinator&) = delete;
+
+    /**
+     * @brief End the work of connected workers and stop listening.
+     */
+    ~SelfPlayCoordinator()
+    {
+        std::string end;
+        SelfPlayWire::append_u32(end, SelfPlayWire::END);
+        for (auto& w: workers)
+        {
+            SelfPlayWire::send_all(w.fd, end);
+            close(w.fd);
+        }
+        if (listener != -1)
+            close(listener);
+    }
+
+    /**
+     * @brief Start listening for workers.
+     * @throw std::runtime_error if the address cannot be bound.
+     */
+    void listen()
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(options.port);
+        if (inet_pton(AF_INET, options.address.c_str(), &address.sin_addr) != 1)
+            throw std::runtime_error("invalid self-play coordinator address");
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        socklen_t size = sizeof(address);
+        if (listener == -1 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listener, 64) != 0 || getsockname(listener, reinterpret_cast<sockaddr*>(&address), &size) != 0)
+            throw std::runtime_error("cannot listen for self-play workers");
+        bound_port = ntohs(address.sin_port);
+    }
+
+    /**
+     * @brief Get the port listened on, e.g. when any free port has been asked for.
+     */
+    int port() const
+    {
+        return bound_port;
+    }
+
+    /**
+     * @brief Play matches on workers, waiting for workers to connect as needed.
+     * @pre listen() has been called.
+     * @return Results of all games.
+     * @throw std::runtime_error if a worker does not know an AI or sends a malformed reply.
+     */
+    SelfPlayReport run(const std::vector<SelfPlayMatch>& matches)
+    {
+        SelfPlayReport report{{}, 0, 0};
+        std::vector<Batch> batches;
+        for (std::size_t m = 0; m < matches.size(); ++m)
+        {
+            report.games.emplace_back(std::max(matches[m].games, 0));
+            int size = std::max(1, options.batch_games);
+            for (int first = 0; first < matches[m].games; first += size)
+                batches.push_back({static_cast<int>(m), first, std::min(size, matches[m].games - first)});
+        }
+        std::deque<int> pending;
+        for (std::size_t i = 0; i < batches.size(); ++i)
+            pending.push_back(i);
+        std::size_t done = 0;
+
+        // Drop a worker, giving its batches to others
+        auto drop = [&](std::size_t w)
+        {
+            for (auto it = workers[w].in_flight.rbegin(); it != workers[w].in_flight.rend(); ++it)
+                pending.push_front(*it);
+            report.requeued += workers[w].in_flight.size();
+            close(workers[w].fd);
+            workers.erase(workers.begin() + w);
+        };
+        auto fill = [&](std::size_t w)
+        {
+            while (!pending.empty() && static_cast<int>(workers[w].in_flight.size()) < std::max(1, options.batches_ahead))
+            {
+                int id = pending.front();
+                if (!SelfPlayWire::send_all(workers[w].fd, batch_message(id, matches[batches[id].match], batches[id])))
+                    return false;
+                pending.pop_front();
+                workers[w].in_flight.push_back(id);
+            }
+            return true;
+        };
+
+        std::vector<pollfd> fds;
+        char buf[1 << 16];
+        while (done < batches.size())
+        {
+            for (std::size_t w = 0; w < workers.size(); )
+            {
+                if (fill(w))
+                    ++w;
+                else
+                    drop(w);
+            }
+            fds.assign(1, {listener, POLLIN, 0});
+            for (auto& w: workers)
+                fds.push_back({w.fd, POLLIN, 0});
+            if (poll(fds.data(), fds.size(), -1) < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                throw std::runtime_error("poll failed in self-play coordinator");
+            }
+            // Handle workers from the back, so that dropping one keeps the indices of the rest
+            for (std::size_t i = fds.size() - 1; i > 0; --i)
+            {
+                if (!fds[i].revents)
+                    continue;
+                Worker& worker = workers[i - 1];
+                ssize_t n = recv(worker.fd, buf, sizeof(buf), 0);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                {
+                    drop(i - 1);
+                    continue;
+                }
+                worker.input.append(buf, n);
+                std::size_t used = 0;
+                while (worker.input.size() - used >= 8)
+                {
+                    const char* p = worker.input.data() + used;
+                    std::uint32_t id = SelfPlayWire::get_u32(p), count = SelfPlayWire::get_u32(p + 4);
+                    if (worker.in_flight.empty() || id != static_cast<std::uint32_t>(worker.in_flight.front()))
+                        throw std::runtime_error("unexpected reply from self-play worker");
+                    const Batch& batch = batches[id];
+                    if (count == 0 && batch.count > 0)
+                        throw std::runtime_error("self-play worker does not know AI " + matches[batch.match].ai0 +
+                            " or " + matches[batch.match].ai1);
+                    if (count != static_cast<std::uint32_t>(batch.count))
+                        throw std::runtime_error("unexpected reply from self-play worker");
+                    std::size_t size = 8 + count * SelfPlayWire::GAME_BYTES;
+                    if (worker.input.size() - used < size)
+                        break;
+                    const unsigned char* g = reinterpret_cast<const unsigned char*>(p + 8);
+                    for (int k = 0; k < batch.count; ++k, g += SelfPlayWire::GAME_BYTES)
+                        report.games[batch.match][batch.first + k] = {static_cast<GameState>(g[0]), g[1] << 8 | g[2],
+                            {static_cast<signed char>(g[3]), static_cast<signed char>(g[4])}};
+                    used += size;
+                    worker.in_flight.pop_front();
+                    ++done;
+                }
+                worker.input.erase(0, used);
+            }
+            if (fds[0].revents)
+            {
+                int fd = accept(listener, nullptr, nullptr);
+                if (fd != -1)
+                {
+                    SelfPlayWire::set_no_delay(fd);
+                    workers.push_back({fd, std::string(), std::deque<int>()});
+                }
+            }
+        }
+        report.workers = workers.size();
+        return report;
+    }
+};
+
+#endif
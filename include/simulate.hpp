@@ -10,8 +10,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include "game_info.hpp"
 #include "control.hpp"
+#include "timing_wheel.hpp"
 
 /**
  * @brief Enumerate values showing whether the game is running, and with detailed reasons
@@ -29,13 +31,98 @@ enum GameState
  * @brief An integrated module for simulation with simple interfaces for your convenience.
  * Built from the game state of a Controller instance, a Simulator object allows you to
  * simulate the whole game and "predict" the future for decision making.
+ * @tparam Map Map descriptor, see DefaultMap.
  */
-class Simulator
+template <typename Map>
+class BasicSimulator
 {
+public:
+    using Info = BasicGameInfo<Map>;        ///< Type of game state
+
 private:
-    GameInfo info;                          ///< Game state
+    Info info;                              ///< Game state
     std::vector<Operation> operations[2];   ///< Players' operations which are about to be applied to current game state. 
 
+    /* Event scheduling of tower attacks */
+
+    TimingWheel<int> tower_events;          ///< Indexes of towers by the attack phase in which they are due
+    std::vector<int> tower_synced;          ///< Attack phase up to which the cd of each tower is exact, or -1 if shielded by EMP
+    std::vector<int> due_towers;            ///< Buffer of due towers
+    int phase = 0;                          ///< Number of attack phases so far
+    bool scheduled = false;                 ///< Whether the schedule matches towers. If not, all cds are exact.
+
+    /**
+     * @brief Get the number of attack phases until a tower is due, capped by the wheel.
+     */
+    static int attack_delay(int cd)
+    {
+        return std::min(std::max(cd, 1), TimingWheel<int>::HORIZON);
+    }
+
+    /**
+     * @brief Schedule every tower not shielded by EMP at the attack phase it is due.
+     */
+    void schedule_towers()
+    {
+        tower_events.clear();
+        tower_synced.assign(info.towers.size(), phase);
+        for (std::size_t i = 0; i < info.towers.size(); ++i)
+        {
+            if (info.is_shielded_by_emp(info.towers[i]))
+                tower_synced[i] = -1; // Neither counts down nor attacks until EMP changes
+            else
+                tower_events.schedule(phase + attack_delay(info.towers[i].cd), i);
+        }
+        scheduled = true;
+    }
+
+    /**
+     * @brief Bring cds of all towers up to date with the attack phases they were not due in.
+     */
+    void sync_towers()
+    {
+        if (!scheduled)
+            return;
+        for (std::size_t i = 0; i < info.towers.size(); ++i)
+        {
+            if (tower_synced[i] < 0 || tower_synced[i] == phase)
+                continue;
+            Tower& tower = info.towers[i];
+            tower.cd = std::max(tower.cd - (phase - tower_synced[i]), 0);
+            tower_synced[i] = phase;
+        }
+    }
+
+    /**
+     * @brief Copy exact cds of towers from another simulator with the same towers, leaving this one unscheduled.
+     */
+    void copy_exact_cds(const BasicSimulator& other)
+    {
+        scheduled = false;
+        phase = 0;
+        if (!other.scheduled)
+            return;
+        for (std::size_t i = 0; i < info.towers.size(); ++i)
+            if (other.tower_synced[i] >= 0)
+                info.towers[i].cd = std::max(other.info.towers[i].cd - (other.phase - other.tower_synced[i]), 0);
+    }
+
+    /**
+     * @brief Check whether applying operations of a player may change towers or their EMP shielding,
+     * which requires rescheduling.
+     */
+    bool affects_towers(int player_id) const
+    {
+        for (auto& op: operations[player_id])
+            if (op.type == BuildTower || op.type == UpgradeTower || op.type == DowngradeTower || op.type == UseEmpBlaster)
+                return true;
+        // An EMP blaster expiring
+        for (auto& sw: info.super_weapons)
+            if (sw.player == player_id && sw.type == EmpBlaster && sw.left_time <= 1)
+                return true;
+        return false;
+    }
+
     /* Round settlement process */
 
     /**
@@ -74,12 +161,18 @@ private:
         // Set deflector property
         for (Ant& ant: info.ants)
             ant.deflector = info.is_shielded_by_deflector(ant);
-        // Attack
-        for (Tower& tower: info.towers)
+        // Attack, in order, with towers due in this phase only. Others would only count down cd,
+        // which is caught up with when they are due or when the state is observed.
+        if (!scheduled)
+            schedule_towers();
+        ++phase;
+        tower_events.take(phase, due_towers);
+        std::sort(due_towers.begin(), due_towers.end());
+        for (int i: due_towers)
         {
-            // Skip if shielded by EMP
-            if (info.is_shielded_by_emp(tower))
-                continue;
+            Tower& tower = info.towers[i];
+            tower.cd = std::max(tower.cd - (phase - 1 - tower_synced[i]), 0);
+            tower_synced[i] = phase;
             // Try to attack
             auto targets = tower.attack(info.ants);
             // Get coins if tower killed the target
@@ -90,6 +183,7 @@ private:
             }
             // Reset tower's damage (clear buff effect)
             tower.damage = TOWER_INFO[tower.type].attack;
+            tower_events.schedule(phase + attack_delay(tower.cd), i);
         }
         // Reset deflector property
         for (Ant& ant: info.ants)
@@ -122,7 +216,7 @@ private:
             if (ant.state == AntState::Alive)
                 ant.move(info.next_move(ant));
             // 4) Check if success (Mark success even if it reaches the age limit)
-            if (ant.x == Base::POSITION[!ant.player][0] && ant.y == Base::POSITION[!ant.player][1])
+            if (ant.x == Map::base_x(!ant.player) && ant.y == Map::base_y(!ant.player))
             {
                 ant.state = AntState::Success;
                 info.update_base_hp(!ant.player, -1);
@@ -186,17 +280,62 @@ public:
      * @brief Construct a new Simulator object from a GameInfo instance. Current game state will be copied.
      * @param info The GaemInfo instance as data source.
      */
-    Simulator(const GameInfo& info) : info(info) {}
+    BasicSimulator(const Info& info) : info(info) {}
+
+    /**
+     * @brief Copy a simulator. The copy starts with exact tower cds and no schedule, which keeps
+     * copies as cheap as copying the game state.
+     */
+    BasicSimulator(const BasicSimulator& other)
+        : info(other.info), operations{other.operations[0], other.operations[1]}
+    {
+        copy_exact_cds(other);
+    }
+
+    /**
+     * @brief Move a simulator, schedule included.
+     */
+    BasicSimulator(BasicSimulator&&) = default;
+
+    /**
+     * @brief Copy another simulator into this one, reusing allocated memory, e.g. to run many
+     * simulations from the same state without reallocating.
+     * @param other The simulator to copy.
+     */
+    void assign(const BasicSimulator& other)
+    {
+        info.assign(other.info);
+        operations[0] = other.operations[0];
+        operations[1] = other.operations[1];
+        copy_exact_cds(other);
+    }
 
     /**
      * @brief Get information about current game state.
      * @return A read-only (constant) reference to the current GameInfo object.
+     * @note Cds of towers that were not due to attack are brought up to date here, so they are
+     * only exact through the reference until the simulator is next modified. Call it again then.
      */
-    const GameInfo& get_info()
+    const Info& get_info()
     {
+        sync_towers();
         return info;
     }
 
+    /**
+     * @brief Get memory used by this simulator, by component.
+     * @return Memory usage in bytes.
+     */
+    MemoryUsage memory_usage() const
+    {
+        MemoryUsage usage = info.memory_usage();
+        usage.object = sizeof(*this);
+        for (auto& ops: operations)
+            usage.operations += ops.capacity() * sizeof(Operation);
+        usage.schedule = tower_events.memory_usage() + (tower_synced.capacity() + due_towers.capacity()) * sizeof(int);
+        return usage;
+    }
+
     /**
      * @brief Get added operations of a player.
      * @param player_id The player.
@@ -230,6 +369,11 @@ public:
      */
     void apply_operations_of_player(int player_id)
     {
+        if (affects_towers(player_id))
+        {
+            sync_towers();
+            scheduled = false;
+        }
         // 1) count down long-lasting weapons' left-time
         info.count_down_super_weapons_left_time(player_id);
         // 2) apply opponent's operations
@@ -243,6 +387,19 @@ public:
      * @return Current game state (running / ended with some reasons).
      */
     GameState next_round()
+    {
+        return next_round(nullptr);
+    }
+
+    /**
+     * @brief Update game state at the end of current round, and get the ants of the round as
+     * judger reports them to players, e.g. to act as a local judger.
+     * @param reported Result: ants of this round, including those which died, succeeded or aged out
+     *        in it, followed by ants generated in it. Controller::read_round_info() relies on this.
+     *        Unchanged if the game ends before ants are settled. Ignored if null.
+     * @return Current game state (running / ended with some reasons).
+     */
+    GameState next_round(std::vector<Ant>* reported)
     {
         // 1) Judge winner at MAX_ROUND
         if (info.round == MAX_ROUND)
@@ -254,12 +411,16 @@ public:
         if (state != GameState::Running)
             return state;
         // 4) Update pheromone
-        info.global_pheromone_attenuation();
-        info.update_pheromone_for_ants();
+        info.update_pheromone_for_round();
+        if (reported)
+            *reported = info.ants;
         // 5) Clear dead and succeeded ants
         info.clear_dead_and_succeeded_ants();
         // 6) Barracks generate new ants
+        std::size_t survivors = info.ants.size();
         generate_ants();
+        if (reported)
+            reported->insert(reported->end(), info.ants.begin() + survivors, info.ants.end());
         // 7) Get basic income
         get_basic_income(0);
         get_basic_income(1);
@@ -273,4 +434,9 @@ public:
 
         return GameState::Running;
     }
-};
\ No newline at end of file
+};
+
+/**
+ * @brief Simulator on the default map.
+ */
+using Simulator = BasicSimulator<DefaultMap>;
\ No newline at end of file
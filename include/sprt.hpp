@@ -0,0 +1,230 @@
+/**
+ * @file sprt.hpp
+ * @author Yufei Li, Jingxuan Liu
+ * @brief Sequential probability ratio test between two AIs playing in-process.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <thread>
+#include <vector>
+#include "template.hpp"
+
+/**
+ * @brief Hypothesis accepted by an SPRT.
+ */
+enum class SprtDecision
+{
+    AcceptH0,    ///< A is not stronger than B by elo1 (its Elo difference is at most elo0)
+    AcceptH1,    ///< A is stronger than B by at least elo1
+    Inconclusive ///< Neither accepted within the game limit
+};
+
+/**
+ * @brief Result of SprtScheduler::run().
+ */
+struct SprtResult
+{
+    SprtDecision decision;
+    double llr;         ///< Final log-likelihood ratio of H1 against H0
+    int pairs;          ///< Game pairs counted
+    int pentanomial[5]; ///< Pairs by score of A in the pair: 0, 1/2, 1, 3/2 and 2
+    int wins;           ///< Games won by A
+    int draws;
+    int losses;
+    double score;       ///< Mean score of A per game, within [0, 1]
+    int games_played;   ///< Games played, including those of the last batch after the decision
+};
+
+/**
+ * @brief SPRT match scheduler for A/B tests of AIs.
+ *
+ * Games are played in pairs: with the seed of a pair, A plays as player 0 and then as player 1,
+ * so the advantage of a side or of a pheromone layout cancels out within the pair. Batches of
+ * pairs are played in parallel with play_game(). Results are then counted in seed order, so the
+ * test is reproducible whatever the number of threads. After each pair, the log-likelihood ratio
+ * of H1 (A is elo1 stronger) against H0 (A is elo0 stronger) is updated, and the test stops as
+ * soon as it crosses a bound.
+ *
+ * The ratio is the usual normal approximation on pair scores (the generalized SPRT):
+ * LLR = N (s1 - s0) (2 x - s0 - s1) / (2 var), where x and var are the mean and the variance of
+ * the score of a pair per game, and s0, s1 the expected scores under H0 and H1. Pairs are counted
+ * in the 5 buckets of their score (pentanomial), and x and var are estimated with PRIOR_PAIRS
+ * pseudo-pairs added to each bucket. The prior alone has the largest variance of a pair score,
+ * 1/8, so the first pairs cannot make the test overconfident, and a run of identical pairs, e.g.
+ * an AI against itself, lowers the variance gradually instead of to a floor.
+ *
+ * @code
+ * SprtScheduler::Options options;
+ * options.elo1 = 20;
+ * SprtResult result = SprtScheduler(options).run(new_ai, old_ai);
+ * if (result.decision == SprtDecision::AcceptH0)
+ *     std::puts("no improvement");
+ * @endcode
+ */
+class SprtScheduler
+{
+public:
+    /**
+     * @brief Hypotheses, error rates and limits of a test.
+     */
+    struct Options
+    {
+        double elo0 = 0;                  ///< Elo difference of A over B under H0
+        double elo1 = 10;                 ///< Elo difference of A over B under H1
+        double alpha = 0.05;              ///< Probability of accepting H1 when H0 holds
+        double beta = 0.05;               ///< Probability of accepting H0 when H1 holds
+        int max_pairs = 20000;            ///< Game pairs after which the test is inconclusive
+        int threads = 0;                  ///< Game threads, or 0 for one per hardware thread
+        int batch_pairs = 0;              ///< Game pairs per batch, or 0 for one per thread
+        unsigned long long seed = 1;      ///< Seed of the first pair. Pair i uses seed + i.
+    };
+
+    static constexpr double PRIOR_PAIRS = 1; ///< Pseudo-pairs added to each bucket of pair scores
+
+private:
+    Options options;
+
+    /**
+     * @brief Expected score of an Elo difference.
+     */
+    static double expected_score(double elo)
+    {
+        return 1 / (1 + std::pow(10, -elo / 400));
+    }
+
+    /**
+     * @brief Score of player 0 in a finished game.
+     */
+    static double score_of_player0(GameState state)
+    {
+        return state == GameState::Player0Win ? 1 : state == GameState::Player1Win ? 0 : 0.5;
+    }
+
+public:
+    SprtScheduler() : SprtScheduler(Options()) {}
+
+    explicit SprtScheduler(const Options& options) : options(options) {}
+
+    /**
+     * @brief Get the lower bound of the ratio, under which H0 is accepted.
+     */
+    double lower_bound() const
+    {
+        return std::log(options.beta / (1 - options.alpha));
+    }
+
+    /**
+     * @brief Get the upper bound of the ratio, above which H1 is accepted.
+     */
+    double upper_bound() const
+    {
+        return std::log((1 - options.beta) / options.alpha);
+    }
+
+    /**
+     * @brief Compute the log-likelihood ratio of pair scores.
+     * @param pentanomial Pairs by score of A in the pair: 0, 1/2, 1, 3/2 and 2.
+     */
+    double llr(const int (&pentanomial)[5]) const
+    {
+        double pairs = 0, weight = 0, sum = 0, sum_squares = 0;
+        for (int k = 0; k < 5; ++k)
+        {
+            double score = k / 4.0, n = pentanomial[k] + PRIOR_PAIRS;
+            pairs += pentanomial[k];
+            weight += n;
+            sum += n * score;
+            sum_squares += n * score * score;
+        }
+        double mean = sum / weight;
+        double variance = sum_squares / weight - mean * mean;
+        double s0 = expected_score(options.elo0), s1 = expected_score(options.elo1);
+        return pairs * (s1 - s0) * (2 * mean - s0 - s1) / (2 * variance);
+    }
+
+    /**
+     * @brief Run a test of A against B.
+     * @param a AI A. Called from game threads, so it must be safe to call concurrently.
+     * @param b AI B, likewise.
+     * @return The decision and the results counted.
+     * @throw Whatever an AI throws.
+     */
+    SprtResult run(AI a, AI b) const
+    {
+        int threads = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+        threads = std::max(1, threads);
+        int batch = options.batch_pairs > 0 ? options.batch_pairs : threads;
+        SprtResult result{SprtDecision::Inconclusive, 0, 0, {0, 0, 0, 0, 0}, 0, 0, 0, 0, 0};
+        std::vector<GameState> states;
+        for (int first = 0; first < options.max_pairs; first += batch)
+        {
+            // Play a batch: game 2i has A as player 0, game 2i + 1 has A as player 1
+            int games = 2 * std::min(batch, options.max_pairs - first);
+            states.assign(games, GameState::Running);
+            std::atomic<int> next(0);
+            std::exception_ptr error;
+            std::atomic<bool> failed(false);
+            auto work = [&]
+            {
+                for (int i = next++; i < games && !failed; i = next++)
+                {
+                    try
+                    {
+                        unsigned long long seed = options.seed + first + i / 2;
+                        states[i] = i % 2 == 0 ? play_game(a, b, seed) : play_game(b, a, seed);
+                    }
+                    catch (...)
+                    {
+                        if (!failed.exchange(true))
+                            error = std::current_exception();
+                    }
+                }
+            };
+            std::vector<std::thread> workers;
+            for (int t = 1; t < std::min(threads, games); ++t)
+                workers.emplace_back(work);
+            work();
+            for (auto& w: workers)
+                w.join();
+            if (error)
+                std::rethrow_exception(error);
+            result.games_played += games;
+
+            // Count pairs in seed order
+            for (int i = 0; i < games; i += 2)
+            {
+                double scores[2] = {score_of_player0(states[i]), 1 - score_of_player0(states[i + 1])};
+                for (double score: scores)
+                {
+                    result.wins += score == 1;
+                    result.draws += score == 0.5;
+                    result.losses += score == 0;
+                }
+                ++result.pairs;
+                ++result.pentanomial[static_cast<int>(2 * (scores[0] + scores[1]))];
+                result.llr = llr(result.pentanomial);
+                if (result.llr <= lower_bound())
+                    result.decision = SprtDecision::AcceptH0;
+                else if (result.llr >= upper_bound())
+                    result.decision = SprtDecision::AcceptH1;
+                if (result.decision != SprtDecision::Inconclusive)
+                    break;
+            }
+            if (result.decision != SprtDecision::Inconclusive)
+                break;
+        }
+        result.score = result.pairs ? (result.wins + 0.5 * result.draws) / (2 * result.pairs) : 0;
+        return result;
+    }
+};
+
+constexpr double SprtScheduler::PRIOR_PAIRS;
@@ -14,70 +14,207 @@
 #include "simulate.hpp"
 
 #include <vector>
+#include <cstdint>
+#include <cstdlib>
 #include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
 
 /**
  * @brief Callback that takes player id and game info as input and returns operations.
 */
 using AI = std::function<std::vector<Operation>(int, const GameInfo &)>;
 
+/**
+ * @brief Rounds between writes of the trace by run_with_ai() in builds with ANTWAR_TRACE.
+ */
+static constexpr int TRACE_DUMP_ROUNDS = 64;
+
+
+/**
+ * @brief Play a whole game between two AIs in-process, with a Simulator in place of judger.
+ * @param ai0 AI callback of player 0.
+ * @param ai1 AI callback of player 1.
+ * @param seed Seed for pheromone initialization.
+ * @param on_end (Optional) Callback called with the game information at the end of the game.
+ * @return Final game state (never GameState::Running).
+ */
+static GameState play_game(AI ai0, AI ai1, unsigned long long seed,
+                           std::function<void(const GameInfo&)> on_end = nullptr)
+{
+    Simulator s(GameInfo{seed});
+    AI ais[2] = {ai0, ai1};
+    while (true)
+    {
+        // Player 0 acts first and player 1 sees the result, just like in the real game
+        for (int player = 0; player < 2; ++player)
+        {
+            for (auto &op : ais[player](player, s.get_info()))
+                s.add_operation_of_player(player, op);
+            s.apply_operations_of_player(player);
+        }
+        GameState state = s.next_round();
+        if (state != GameState::Running)
+        {
+            if (on_end)
+                on_end(s.get_info());
+            return state;
+        }
+    }
+}
+
+/**
+ * @brief Serve many games with an AI in one process, as a bot host of the local judger.
+ * @param ai AI callback.
+ * @details Games are multiplexed by channel, one per game and side. Each message from the judger is
+ *          a 4-byte big-endian channel, a 4-byte big-endian length and the usual text message, and an
+ *          empty message ends the game of its channel. A message on a new channel is the init info of
+ *          a new game, with its own Controller. Each reply is the channel followed by the usual reply
+ *          of a bot. Returns when stdin is closed.
+ */
+static void host_with_ai(AI ai)
+{
+    struct HostedGame
+    {
+        Controller c;
+        bool expect_round_info; ///< Whether the next message is round info rather than operations
+    };
+    std::unordered_map<std::uint32_t, std::unique_ptr<HostedGame>> games;
+    auto read_u32 = [](std::uint32_t& value)
+    {
+        unsigned char buf[4];
+        if (!std::cin.read(reinterpret_cast<char*>(buf), 4))
+            return false;
+        value = std::uint32_t(buf[0]) << 24 | buf[1] << 16 | buf[2] << 8 | buf[3];
+        return true;
+    };
+    auto decide = [&](std::uint32_t channel, Controller& c)
+    {
+        for (auto &op : ai(c.self_player_id, c.get_info()))
+            c.append_self_operation(op);
+        print_header(static_cast<int>(channel));
+        c.send_self_operations();
+        c.apply_self_operations();
+        std::cout.flush();
+    };
+    std::uint32_t channel, length;
+    std::string message;
+    while (read_u32(channel) && read_u32(length))
+    {
+        message.resize(length);
+        if (length > 0 && !std::cin.read(&message[0], length))
+            break;
+        auto it = games.find(channel);
+        if (length == 0)
+        {
+            if (it != games.end())
+                games.erase(it);
+            continue;
+        }
+        std::istringstream in(message);
+        if (it == games.end())
+        {
+            HostedGame* game = new HostedGame{Controller(read_init_info(in)), false};
+            games[channel].reset(game);
+            // Player 0 decides right after init
+            if (game->c.self_player_id == 0)
+                decide(channel, game->c);
+            continue;
+        }
+        HostedGame& game = *it->second;
+        if (game.expect_round_info)
+        {
+            RoundInfo info = read_round_info(in);
+            game.c.update_round_info(info);
+            game.expect_round_info = false;
+            if (game.c.self_player_id == 0)
+                decide(channel, game.c);
+        }
+        else
+        {
+            game.c.set_opponent_operations(read_opponent_operations(in));
+            game.c.apply_opponent_operations();
+            game.expect_round_info = true;
+            if (game.c.self_player_id == 1)
+                decide(channel, game.c);
+        }
+    }
+}
 
 /**
  * @brief Run the game with an AI that depends only on player id and game state.
  * @param ai AI callback.
+ * @note When environment variable ANTWAR_SELF_PLAY is set to N, the AI plays N games against itself
+ * through play_game() instead of talking to judger. This is the training run of profile-guided builds.
+ * When ANTWAR_HOST is set, it serves many games of the local judger through host_with_ai() instead.
+ * Returns at the end of input, e.g. when judger closes the pipe after the game.
  */
 static void run_with_ai(AI ai)
 {
+    if (std::getenv("ANTWAR_HOST"))
+    {
+        host_with_ai(ai);
+        return;
+    }
+    if (const char* self_play = std::getenv("ANTWAR_SELF_PLAY"))
+    {
+        for (unsigned long long seed = 1, games = std::atoi(self_play); seed <= games; ++seed)
+            play_game(ai, ai, seed);
+        return;
+    }
     Controller c;
     while (true)
     {
-        if (c.self_player_id == 0) // Game process when you are player 0
+        ANTWAR_TRACE_SCOPE("round");
+        // Player 1 receives opponent operations before deciding, and player 0 after
+        if (c.self_player_id == 1)
         {
-            // AI makes decisions
-            std::vector<Operation> ops = ai(c.self_player_id, c.get_info());
-
-            // Add operations to controller
-            for (auto &op : ops)
-                c.append_self_operation(op);
-
-            // Send operations to judger
-            c.send_self_operations();
-
-            // Apply operations to game state
-            c.apply_self_operations();
-
             // Read opponent operations from judger
             c.read_opponent_operations();
+            if (!std::cin)
+                break;
 
             // Apply opponent operations to game state
             c.apply_opponent_operations();
+        }
 
-            // Read round info from judger
-            c.read_round_info();
+        // AI makes decisions
+        std::vector<Operation> ops;
+        {
+            ANTWAR_TRACE_SCOPE("ai");
+            ops = ai(c.self_player_id, c.get_info());
         }
-        else // Game process when you are player 1
+
+        // Add operations to controller
+        for (auto &op : ops)
+            c.append_self_operation(op);
+
+        // Send operations to judger
+        c.send_self_operations();
+
+        // Apply operations to game state
+        c.apply_self_operations();
+
+        if (c.self_player_id == 0)
         {
             // Read opponent operations from judger
             c.read_opponent_operations();
+            if (!std::cin)
+                break;
 
             // Apply opponent operations to game state
             c.apply_opponent_operations();
+        }
 
-            // AI makes decisions
-            std::vector<Operation> ops = ai(c.self_player_id, c.get_info());
-
-            // Add operations to controller
-            for (auto &op : ops)
-                c.append_self_operation(op);
-
-            // Send operations to judger
-            c.send_self_operations();
-
-            // Apply operations to game state
-            c.apply_self_operations();
+        // Read round info from judger
+        c.read_round_info();
+        if (!std::cin)
+            break;
 
-            // Read round info from judger
-            c.read_round_info();
-        }
+        // Judgers kill bots at the end of a game, so traces are also written along the way
+        if (c.get_info().round % TRACE_DUMP_ROUNDS == 0)
+            ANTWAR_TRACE_DUMP_DEFAULT();
     }
 }
\ No newline at end of file
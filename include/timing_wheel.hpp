@@ -0,0 +1,93 @@
+/**
+ * @file timing_wheel.hpp
+ * @author Yufei Li, Jingxuan Liu
+ * @brief A timing wheel of events keyed by round.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Timing wheel: events are kept in a ring of slots indexed by their due time modulo the
+ * number of slots, so scheduling and taking the events of a time are O(1) per event.
+ *
+ * Times must not go backwards, and events can be scheduled at most SLOTS - 1 steps ahead of the
+ * last time taken. Events due later should be scheduled at the latest possible time and
+ * rescheduled when they come up.
+ *
+ * @tparam T Type of events.
+ * @tparam SLOTS Number of slots, a power of 2.
+ */
+template <typename T, int SLOTS = 64>
+class TimingWheel
+{
+    static_assert(SLOTS > 0 && (SLOTS & (SLOTS - 1)) == 0, "SLOTS must be a power of 2");
+
+private:
+    std::vector<T> slots[SLOTS];
+    std::size_t count = 0;
+
+public:
+    static constexpr int HORIZON = SLOTS - 1; ///< Max number of steps to schedule ahead
+
+    /**
+     * @brief Schedule an event.
+     * @param time Due time, within HORIZON steps of the last time taken.
+     * @param event The event.
+     */
+    void schedule(long long time, T event)
+    {
+        slots[time & (SLOTS - 1)].push_back(event);
+        ++count;
+    }
+
+    /**
+     * @brief Take all events due at a time, in the order they were scheduled.
+     * @param time The time.
+     * @param events Result, replaced by the events. Its memory is swapped into the wheel for reuse.
+     */
+    void take(long long time, std::vector<T>& events)
+    {
+        events.clear();
+        events.swap(slots[time & (SLOTS - 1)]);
+        count -= events.size();
+    }
+
+    /**
+     * @brief Drop all events, keeping allocated memory.
+     */
+    void clear()
+    {
+        for (auto& slot: slots)
+            slot.clear();
+        count = 0;
+    }
+
+    /**
+     * @brief Get heap memory allocated by slots, in bytes.
+     */
+    std::size_t memory_usage() const
+    {
+        std::size_t bytes = 0;
+        for (auto& slot: slots)
+            bytes += slot.capacity() * sizeof(T);
+        return bytes;
+    }
+
+    /**
+     * @brief Get the number of scheduled events.
+     */
+    std::size_t size() const
+    {
+        return count;
+    }
+};
+
+template <typename T, int SLOTS>
+constexpr int TimingWheel<T, SLOTS>::HORIZON;
@@ -0,0 +1,345 @@
+/**
+ * @file tower_planner.hpp
+ * @author Yufei Li, Jingxuan Liu
+ * @brief Ranking tower builds and upgrades by coverage of forecast ant traffic.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include "game_info.hpp"
+#include "weapon_placement.hpp"
+#include "flow_field.hpp"
+
+/**
+ * @brief A ranked tower plan: build a tower or upgrade an existing one, possibly in several steps,
+ * to reach a target type.
+ */
+struct TowerPlan
+{
+    int x, y;
+    int tower_id;        ///< Id of the tower to upgrade, or -1 for a new tower
+    TowerType type;      ///< Target type
+    Operation first;     ///< Operation of the first step, to be applied now
+    int steps;           ///< Number of operations, i.e. rounds, to reach the target type
+    double value;        ///< Expected coins from damage dealt over the horizon
+    double cost;         ///< Coins for all steps
+    double score;        ///< value - cost
+};
+
+/**
+ * @brief Planner of tower builds and upgrades for a player.
+ *
+ * Every free highland cell is evaluated for every tower type, and every own tower for every type
+ * it can be upgraded to. A tower of type t at cell c is worth
+ *
+ *     horizon * damage_rate(t) * splash(t) * min(1, coverage(c, range(t))) * coins_per_damage
+ *
+ * where coverage is the forecast number of enemy ant visits per round to cells within range, and
+ * coins_per_damage is what killing an enemy ant of current level rewards per hp. A plan scores its
+ * value gain minus the coins spent by build_tower_cost() and upgrade_tower_cost().
+ *
+ * Coverage sums are kept for every range towers have (2 to 6) and updated incrementally: when
+ * traffic changes, only changed cells are added to the sums around them. Towers being built or
+ * destroyed change neither, so planning every round is cheap.
+ *
+ * @code
+ * TowerPlanner planner(c.self_player_id);
+ * ...
+ * planner.update(c.get_info()); // Every round
+ * auto plans = planner.plan(c.get_info(), 5);
+ * if (!plans.empty() && plans[0].score > 0)
+ *     c.append_self_operation(plans[0].first);
+ * @endcode
+ */
+class TowerPlanner
+{
+public:
+    static constexpr int MIN_RANGE = 2, MAX_RANGE = 6; ///< Ranges of all tower types
+
+private:
+    int player;
+    int horizon;
+    double traffic[MAP_CELLS];                          ///< Enemy ant visits per round, by cell
+    double coverage[MAX_RANGE + 1][MAP_CELLS];          ///< Sum of traffic within each range of each cell
+
+    /**
+     * @brief Add a traffic change at a cell to coverage sums around it.
+     */
+    void spread(int cell, double delta)
+    {
+        for (int range = MIN_RANGE; range <= MAX_RANGE; ++range)
+        {
+            double* c = coverage[range];
+            for (int center: disk_table(range)[cell])
+                c[center] += delta;
+        }
+    }
+
+public:
+    /**
+     * @brief Estimate the number of ants a tower hits per attack, relative to a single target tower.
+     */
+    static double splash_factor(TowerType type)
+    {
+        switch (type)
+        {
+            case Double:                    // Two targets
+            case Pulse:                     // Everything in range
+            case Missile:                   // Radius 2 around the target
+                return 2.0;
+            case Mortar:                    // Radius 1 around the target
+            case MortarPlus:
+                return 1.5;
+            case Ice:                       // Frozen ants stay in range for one more round
+                return 1.25;
+            default:
+                return 1.0;
+        }
+    }
+
+    /**
+     * @brief Get the types reachable from a type by upgrading, i.e. the type itself and its subtree.
+     */
+    static std::vector<TowerType> reachable_types(TowerType type)
+    {
+        std::vector<TowerType> types{type};
+        if (type == Basic)
+        {
+            for (int branch = 1; branch <= 3; ++branch)
+            {
+                types.push_back(static_cast<TowerType>(branch));
+                for (int leaf = 1; leaf <= 3; ++leaf)
+                    types.push_back(static_cast<TowerType>(branch * 10 + leaf));
+            }
+        }
+        else if (type < 10)
+            for (int leaf = 1; leaf <= 3; ++leaf)
+                types.push_back(static_cast<TowerType>(type * 10 + leaf));
+        return types;
+    }
+
+    /**
+     * @brief Get the coins to upgrade a tower from one type to a reachable one.
+     */
+    static int upgrade_chain_cost(TowerType from, TowerType to)
+    {
+        int cost = 0;
+        for (int t = to; t != from; t /= 10)
+            cost += GameInfo::upgrade_tower_cost(t);
+        return cost;
+    }
+
+    /**
+     * @brief Get the number of upgrades from one type to a reachable one.
+     */
+    static int upgrade_chain_length(TowerType from, TowerType to)
+    {
+        int steps = 0;
+        for (int t = to; t != from; t /= 10)
+            ++steps;
+        return steps;
+    }
+
+    /**
+     * @brief Forecast enemy ant traffic against a player from current pheromone.
+     *
+     * Ants choose moves deterministically from pheromone (GameInfo::next_move()), so an ant born
+     * now follows a known path. A "ghost" ant is walked from the enemy base to find it, and every
+     * cell on it gets the spawn rate of the enemy base as visits per round. Every alive enemy ant
+     * is walked on as well, adding one visit per cell over the horizon. Moves only depend on the
+     * cell and the last move, so they are memoized, and ants on the same route share them.
+     *
+     * @param info Current game state.
+     * @param player The defending player.
+     * @param horizon Number of rounds ahead.
+     * @param traffic Result, visits per round by cell.
+     */
+    static void forecast_traffic(const GameInfo& info, int player, int horizon, double traffic[MAP_CELLS])
+    {
+        std::fill(traffic, traffic + MAP_CELLS, 0.0);
+        int enemy = !player;
+        const Base& base = info.bases[enemy];
+        // Next move by cell and last move (6 for none), or -1 if unknown yet
+        signed char moves[MAP_CELLS][7];
+        std::fill(&moves[0][0], &moves[0][0] + MAP_CELLS * 7, -1);
+        auto walk = [&](Ant ant, int rounds, double weight)
+        {
+            for (int i = 0; i < rounds && ant.age <= Ant::AGE_LIMIT; ++i, ++ant.age)
+            {
+                signed char& move = moves[ant.x * MAP_SIZE + ant.y][ant.path.empty() ? 6 : ant.path.back()];
+                if (move < 0)
+                    move = info.next_move(ant);
+                ant.move(move);
+                traffic[ant.x * MAP_SIZE + ant.y] += weight;
+                if (ant.x == Base::POSITION[player][0] && ant.y == Base::POSITION[player][1])
+                    break;
+            }
+        };
+        double spawn_rate = 1.0 / Base::GENERATION_CYCLE_INFO[base.gen_speed_level];
+        walk(Ant(-1, enemy, base.x, base.y, Ant::MAX_HP_INFO[base.ant_level], base.ant_level, 0, AntState::Alive),
+            Ant::AGE_LIMIT, spawn_rate);
+        for (const Ant& ant: info.ants)
+            if (ant.player == enemy && ant.is_alive())
+                walk(ant, horizon, 1.0 / horizon);
+    }
+
+    /**
+     * @brief Construct a planner with no traffic.
+     * @param player The player to plan for.
+     * @param horizon (Optional) Number of rounds a tower is valued over.
+     */
+    explicit TowerPlanner(int player, int horizon = 32)
+        : player(player), horizon(horizon), traffic{}, coverage{} {}
+
+    /**
+     * @brief Replace traffic, updating coverage sums of changed cells only.
+     * @param new_traffic Enemy ant visits per round, by cell.
+     * @return Number of changed cells.
+     */
+    int set_traffic(const double new_traffic[MAP_CELLS])
+    {
+        int changed = 0;
+        for (int cell = 0; cell < MAP_CELLS; ++cell)
+        {
+            double delta = new_traffic[cell] - traffic[cell];
+            if (delta == 0)
+                continue;
+            traffic[cell] = new_traffic[cell];
+            spread(cell, delta);
+            ++changed;
+        }
+        return changed;
+    }
+
+    /**
+     * @brief Forecast traffic of current game state and update coverage sums incrementally.
+     * @param info Current game state.
+     * @return Number of changed cells.
+     */
+    int update(const GameInfo& info)
+    {
+        double forecast[MAP_CELLS];
+        forecast_traffic(info, player, horizon, forecast);
+        return set_traffic(forecast);
+    }
+
+    /**
+     * @brief Take traffic from a flow field, i.e. visits of enemy ants averaged over its horizon,
+     * and update coverage sums incrementally.
+     * @param flow Flow field updated to current game state.
+     * @return Number of changed cells.
+     */
+    int update(const FlowField& flow)
+    {
+        double rates[MAP_CELLS];
+        const float* visits = flow.visits(!player);
+        for (int cell = 0; cell < MAP_CELLS; ++cell)
+            rates[cell] = static_cast<double>(visits[cell]) / flow.get_horizon();
+        return set_traffic(rates);
+    }
+
+    /**
+     * @brief Recompute all coverage sums from scratch, e.g. to drop accumulated rounding errors.
+     */
+    void recompute()
+    {
+        std::fill(&coverage[0][0], &coverage[0][0] + (MAX_RANGE + 1) * MAP_CELLS, 0.0);
+        for (int cell = 0; cell < MAP_CELLS; ++cell)
+            if (traffic[cell] != 0)
+                spread(cell, traffic[cell]);
+    }
+
+    /**
+     * @brief Get forecast traffic within a range of a cell.
+     */
+    double coverage_of(int x, int y, int range) const
+    {
+        return coverage[range][x * MAP_SIZE + y];
+    }
+
+    /**
+     * @brief Get the expected coins from damage of a tower of given type at a cell over the horizon.
+     */
+    double tower_value(const GameInfo& info, int x, int y, TowerType type) const
+    {
+        const TowerInfo& t = TOWER_INFO[type];
+        int level = info.bases[!player].ant_level;
+        double coins_per_damage = static_cast<double>(Ant::REWARD_INFO[level]) / Ant::MAX_HP_INFO[level];
+        double hit_rate = std::min(1.0, coverage[t.range][x * MAP_SIZE + y]);
+        return horizon * t.attack / t.speed * splash_factor(type) * hit_rate * coins_per_damage;
+    }
+
+    /**
+     * @brief Rank builds and upgrades of the player.
+     * @param info Current game state.
+     * @param k Max number of plans.
+     * @return Plans whose first step is valid now, best first. Affordability is not checked.
+     */
+    std::vector<TowerPlan> plan(const GameInfo& info, std::size_t k) const
+    {
+        std::vector<TowerPlan> plans;
+        int build_cost = GameInfo::build_tower_cost(info.tower_num_of_player(player));
+        static const std::vector<TowerType> all_types = reachable_types(Basic);
+        plans.reserve(MAP_CELLS);
+        // New towers
+        for (int x = 0; x < MAP_SIZE; ++x)
+            for (int y = 0; y < MAP_SIZE; ++y)
+            {
+                Operation build(BuildTower, x, y);
+                if (!is_highland(player, x, y) || !info.is_operation_valid(player, build))
+                    continue;
+                for (TowerType type: all_types)
+                {
+                    double value = tower_value(info, x, y, type);
+                    double cost = build_cost + upgrade_chain_cost(Basic, type);
+                    plans.push_back(TowerPlan{x, y, -1, type, build, 1 + upgrade_chain_length(Basic, type),
+                        value, cost, value - cost});
+                }
+            }
+        // Upgrades of own towers
+        for (const Tower& tower: info.towers)
+        {
+            if (tower.player != player)
+                continue;
+            double current = tower_value(info, tower.x, tower.y, tower.type);
+            for (TowerType type: reachable_types(tower.type))
+            {
+                if (type == tower.type)
+                    continue;
+                // The first step is the level-2 type on the way
+                int next = type;
+                while (next / 10 != tower.type && next >= 10)
+                    next /= 10;
+                Operation upgrade(UpgradeTower, tower.id, next);
+                if (!info.is_operation_valid(player, upgrade))
+                    continue;
+                double value = tower_value(info, tower.x, tower.y, type) - current;
+                double cost = upgrade_chain_cost(tower.type, type);
+                plans.push_back(TowerPlan{tower.x, tower.y, tower.id, type, upgrade,
+                    upgrade_chain_length(tower.type, type), value, cost, value - cost});
+            }
+        }
+        auto better = [](const TowerPlan& a, const TowerPlan& b)
+        {
+            if (a.score != b.score)
+                return a.score > b.score;
+            if (a.x != b.x || a.y != b.y)
+                return a.x != b.x ? a.x < b.x : a.y < b.y;
+            return a.type < b.type;
+        };
+        if (plans.size() > k)
+        {
+            std::partial_sort(plans.begin(), plans.begin() + k, plans.end(), better);
+            plans.erase(plans.begin() + k, plans.end());
+        }
+        else
+            std::sort(plans.begin(), plans.end(), better);
+        return plans;
+    }
+};
@@ -0,0 +1,217 @@
+/**
+ * @file trace.hpp
+ * @author Yufei Li, Jingxuan Liu
+ * @brief Lightweight scoped-timer tracing, exported as Chrome trace events.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * @note Tracing is compiled out unless ANTWAR_TRACE is defined (e.g. "make CXXFLAGS='-std=c++11
+ * -O2 -DANTWAR_TRACE' ..."), in which case every ANTWAR_TRACE_SCOPE() records a span into a
+ * preallocated ring buffer. The buffer is written as Chrome trace_event JSON at exit, to the file
+ * named by environment variable ANTWAR_TRACE_FILE ("trace.json" by default), or on demand with
+ * ANTWAR_TRACE_DUMP() and ANTWAR_TRACE_DUMP_DEFAULT(). Bots killed by judger never exit normally,
+ * so run_with_ai() also writes the trace every TRACE_DUMP_ROUNDS rounds. Open the file in
+ * chrome://tracing or https://ui.perfetto.dev.
+ */
+
+#pragma once
+
+#ifdef ANTWAR_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @brief A finished span.
+ */
+struct TraceEvent
+{
+    const char* name;    ///< Name of the span, which must be a string literal
+    long long start;     ///< Start time in ticks
+    long long duration;  ///< Duration in ticks
+    int thread;          ///< Index of the recording thread
+};
+
+/**
+ * @brief Global recorder of spans, keeping the latest CAPACITY spans in a ring buffer.
+ */
+class Tracer
+{
+public:
+    static constexpr std::size_t CAPACITY = 1 << 16; ///< Number of spans kept, a power of 2
+
+private:
+    TraceEvent events[CAPACITY];
+    std::atomic<std::size_t> count; ///< Number of spans ever recorded
+    std::atomic<int> thread_count;  ///< Number of threads ever recording
+    long long origin_ticks;         ///< Ticks at construction, for calibration
+    long long origin_ns;            ///< Nanoseconds at construction, for calibration
+
+    Tracer() : count(0), thread_count(0), origin_ticks(now()), origin_ns(now_ns()) {}
+
+    ~Tracer()
+    {
+        dump();
+    }
+
+public:
+    /**
+     * @brief Get the global tracer.
+     */
+    static Tracer& instance()
+    {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    /**
+     * @brief Get current time in nanoseconds from a monotonic clock.
+     */
+    static long long now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Get current time in ticks, i.e. the time stamp counter on x86, which is about twice as
+     * fast to read as the monotonic clock, or nanoseconds elsewhere. Ticks are converted into
+     * nanoseconds when dumped.
+     */
+    static long long now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return now_ns();
+#endif
+    }
+
+    /**
+     * @brief Get the index of the calling thread, which is assigned on first use.
+     */
+    int thread_index()
+    {
+        static thread_local int index = thread_count++;
+        return index;
+    }
+
+    /**
+     * @brief Record a finished span, overwriting the oldest one if the buffer is full.
+     * @param name Name of the span, which must be a string literal.
+     * @param start Start time in ticks.
+     * @param end End time in ticks.
+     */
+    void record(const char* name, long long start, long long end)
+    {
+        std::size_t i = count.fetch_add(1, std::memory_order_relaxed) & (CAPACITY - 1);
+        events[i] = TraceEvent{name, start, end - start, thread_index()};
+    }
+
+    /**
+     * @brief Discard all recorded spans.
+     */
+    void clear()
+    {
+        count = 0;
+    }
+
+    /**
+     * @brief Write recorded spans to the file named by ANTWAR_TRACE_FILE, or "trace.json".
+     * @return Whether the file is written.
+     */
+    bool dump() const
+    {
+        const char* path = std::getenv("ANTWAR_TRACE_FILE");
+        return dump(path ? path : "trace.json");
+    }
+
+    /**
+     * @brief Write recorded spans as Chrome trace_event JSON. Nothing is written if there is no span.
+     * @param path Path of the output file. It is replaced at once when complete, so a process
+     *        killed while writing leaves the previous file intact.
+     * @return Whether the file is written.
+     */
+    bool dump(const char* path) const
+    {
+        std::size_t total = count.load(), first = total > CAPACITY ? total - CAPACITY : 0;
+        if (total == 0)
+            return false;
+        std::string temp = std::string(path) + ".tmp";
+        std::FILE* file = std::fopen(temp.c_str(), "w");
+        if (!file)
+            return false;
+        // Calibrate ticks against the monotonic clock over the lifetime of the tracer
+        long long ticks = now() - origin_ticks, ns = now_ns() - origin_ns;
+        double ns_per_tick = ticks > 0 ? static_cast<double>(ns) / ticks : 1.0;
+        std::fputs("{\"traceEvents\":[\n", file);
+        for (std::size_t i = first; i < total; ++i)
+        {
+            const TraceEvent& e = events[i & (CAPACITY - 1)];
+            std::fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%d}%s\n",
+                e.name, (e.start - origin_ticks) * ns_per_tick / 1000.0, e.duration * ns_per_tick / 1000.0,
+                e.thread, i + 1 < total ? "," : "");
+        }
+        std::fputs("],\"displayTimeUnit\":\"ns\"}\n", file);
+        return std::fclose(file) == 0 && std::rename(temp.c_str(), path) == 0;
+    }
+};
+
+/**
+ * @brief Span recorded from its construction to its destruction.
+ */
+class ScopedTrace
+{
+private:
+    const char* name;
+    long long start;
+
+public:
+    /**
+     * @brief Start a span. The tracer is constructed first if needed, so that its time origin
+     * precedes the span.
+     */
+    explicit ScopedTrace(const char* name) : name(name)
+    {
+        Tracer::instance();
+        start = Tracer::now();
+    }
+
+    ~ScopedTrace()
+    {
+        Tracer::instance().record(name, start, Tracer::now());
+    }
+
+    ScopedTrace(const ScopedTrace&) = delete;
+    ScopedTrace& operator=(const ScopedTrace&) = delete;
+};
+
+#define ANTWAR_TRACE_CONCAT_(a, b) a##b
+#define ANTWAR_TRACE_CONCAT(a, b) ANTWAR_TRACE_CONCAT_(a, b)
+/**
+ * @brief Record a span named "name" (a string literal) until the end of current scope.
+ */
+#define ANTWAR_TRACE_SCOPE(name) ScopedTrace ANTWAR_TRACE_CONCAT(antwar_trace_, __LINE__)(name)
+/**
+ * @brief Write recorded spans to file "path" right now.
+ */
+#define ANTWAR_TRACE_DUMP(path) Tracer::instance().dump(path)
+/**
+ * @brief Write recorded spans right now to the file they are written to at exit.
+ */
+#define ANTWAR_TRACE_DUMP_DEFAULT() Tracer::instance().dump()
+
+#else
+
+#define ANTWAR_TRACE_SCOPE(name) ((void)0)
+#define ANTWAR_TRACE_DUMP(path) ((void)0)
+#define ANTWAR_TRACE_DUMP_DEFAULT() ((void)0)
+
+#endif
@@ -0,0 +1,225 @@
+/**
+ * @file weapon_placement.hpp
+ * @author Yufei Li, Jingxuan Liu
+ * @brief Scoring every center of every super weapon in one sweep.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include "game_info.hpp"
+
+/**
+ * @brief Number of cells of the map, indexed by "x * MAP_SIZE + y".
+ */
+static constexpr int MAP_CELLS = MAP_SIZE * MAP_SIZE;
+
+/**
+ * @brief Get the valid cells within a distance of every cell, e.g. the cells covered by a super
+ * weapon centered there. Tables are built on first use.
+ * @param range The distance, from 0 to 6.
+ * @return Table indexed by cell, listing cell indexes. Invalid cells have empty lists.
+ */
+inline const std::vector<std::vector<int>>& disk_table(int range)
+{
+    // Built at once, so that first use is safe from any thread
+    static const std::vector<std::vector<std::vector<int>>> tables = []
+    {
+        std::vector<std::vector<std::vector<int>>> tables(7, std::vector<std::vector<int>>(MAP_CELLS));
+        for (int x0 = 0; x0 < MAP_SIZE; ++x0)
+            for (int y0 = 0; y0 < MAP_SIZE; ++y0)
+            {
+                if (!is_valid_pos(x0, y0))
+                    continue;
+                for (int x1 = 0; x1 < MAP_SIZE; ++x1)
+                    for (int y1 = 0; y1 < MAP_SIZE; ++y1)
+                    {
+                        if (!is_valid_pos(x1, y1))
+                            continue;
+                        for (int range = distance(x0, y0, x1, y1); range < 7; ++range)
+                            tables[range][x0 * MAP_SIZE + y0].push_back(x1 * MAP_SIZE + y1);
+                    }
+            }
+        return tables;
+    }();
+    return tables[range];
+}
+
+/**
+ * @brief A scored center of a super weapon.
+ */
+struct WeaponPlacement
+{
+    SuperWeaponType type;
+    int x, y;
+    double score;
+
+    /**
+     * @brief Get the operation using the super weapon here.
+     */
+    Operation operation() const
+    {
+        return Operation(static_cast<OperationType>(UseLightningStorm + type - LightningStorm), x, y);
+    }
+};
+
+/**
+ * @brief Optimizer of super weapon placement, scoring every valid center of every super weapon
+ * of a player at once.
+ *
+ * Scores estimate the immediate effect in the next round:
+ * - LightningStorm: enemy ants killed, i.e. the reward of each plus one per kill;
+ * - EmpBlaster: damage per round of enemy towers disabled;
+ * - Deflector: damage per round that own ants in range would ignore, from enemy towers covering
+ *   them whose damage is below half the max hp of the ant;
+ * - EmergencyEvasion: damage that own ants in range would evade, i.e. the two strongest enemy
+ *   towers covering each, up to its hp.
+ *
+ * Each unit contributes its value to its own cell, and each nonzero cell is then added to all
+ * centers within range through disk_table(), so a sweep costs a few dozen additions per unit
+ * rather than a simulation per center.
+ *
+ * @code
+ * WeaponPlacementOptimizer optimizer;
+ * optimizer.evaluate(c.get_info(), c.self_player_id);
+ * for (auto& p: optimizer.top(LightningStorm, 1))
+ *     c.append_self_operation(p.operation());
+ * @endcode
+ */
+class WeaponPlacementOptimizer
+{
+private:
+    double scores[SuperWeaponCount][MAP_CELLS]; ///< Score of each center, by type
+    bool ready[SuperWeaponCount];               ///< Whether each type is out of cooldown
+
+    /**
+     * @brief Add a value at a cell to every center covering it.
+     */
+    void spread(SuperWeaponType type, int x, int y, double value)
+    {
+        if (value <= 0)
+            return;
+        double* s = scores[type];
+        for (int center: disk_table(SUPER_WEAPON_INFO[type][1])[x * MAP_SIZE + y])
+            s[center] += value;
+    }
+
+public:
+    WeaponPlacementOptimizer() : scores{}, ready{} {}
+
+    /**
+     * @brief Score all centers of all super weapons of a player.
+     * @param info Current game state.
+     * @param player_id The player.
+     */
+    void evaluate(const GameInfo& info, int player_id)
+    {
+        std::fill(&scores[0][0], &scores[0][0] + SuperWeaponCount * MAP_CELLS, 0.0);
+        for (int type = LightningStorm; type < SuperWeaponCount; ++type)
+            ready[type] = info.super_weapon_cd[player_id][type] <= 0;
+
+        // Enemy towers, which attack own ants and can be disabled
+        std::vector<const Tower*> enemy_towers;
+        for (const Tower& tower: info.towers)
+        {
+            if (tower.player == player_id || info.is_shielded_by_emp(tower))
+                continue;
+            enemy_towers.push_back(&tower);
+            spread(EmpBlaster, tower.x, tower.y, tower.damage / tower.speed);
+        }
+
+        for (const Ant& ant: info.ants)
+        {
+            if (!ant.is_alive())
+                continue;
+            if (ant.player != player_id)
+            {
+                spread(LightningStorm, ant.x, ant.y, ant.reward() + 1);
+                continue;
+            }
+            // Damage an own ant is exposed to
+            double blockable = 0;
+            int strongest[2] = {};
+            for (const Tower* tower: enemy_towers)
+            {
+                if (distance(ant.x, ant.y, tower->x, tower->y) > tower->range)
+                    continue;
+                if (tower->damage < ant.max_hp() / 2)
+                    blockable += tower->damage / tower->speed;
+                if (tower->damage > strongest[0])
+                {
+                    strongest[1] = strongest[0];
+                    strongest[0] = tower->damage;
+                }
+                else if (tower->damage > strongest[1])
+                    strongest[1] = tower->damage;
+            }
+            spread(Deflector, ant.x, ant.y, blockable);
+            spread(EmergencyEvasion, ant.x, ant.y, std::min(ant.hp, strongest[0] + strongest[1]));
+        }
+    }
+
+    /**
+     * @brief Get the score of a center, as of the last evaluate().
+     */
+    double score(SuperWeaponType type, int x, int y) const
+    {
+        return scores[type][x * MAP_SIZE + y];
+    }
+
+    /**
+     * @brief Get the best centers of a super weapon, as of the last evaluate().
+     * @param type The super weapon.
+     * @param k Max number of centers.
+     * @return Centers with positive scores, best first. Empty if the super weapon is cooling down.
+     * @note Coins are not checked.
+     */
+    std::vector<WeaponPlacement> top(SuperWeaponType type, int k) const
+    {
+        std::vector<WeaponPlacement> result;
+        if (!ready[type])
+            return result;
+        for (int cell = 0; cell < MAP_CELLS; ++cell)
+            if (scores[type][cell] > 0)
+                result.push_back(WeaponPlacement{type, cell / MAP_SIZE, cell % MAP_SIZE, scores[type][cell]});
+        auto better = [](const WeaponPlacement& a, const WeaponPlacement& b)
+        {
+            return a.score > b.score || (a.score == b.score && (a.x < b.x || (a.x == b.x && a.y < b.y)));
+        };
+        if (static_cast<int>(result.size()) > k)
+        {
+            std::partial_sort(result.begin(), result.begin() + k, result.end(), better);
+            result.resize(k);
+        }
+        else
+            std::sort(result.begin(), result.end(), better);
+        return result;
+    }
+
+    /**
+     * @brief Get the best centers among all super weapons, as of the last evaluate().
+     * @param k Max number of centers.
+     * @return Centers with positive scores, best first.
+     */
+    std::vector<WeaponPlacement> top(int k) const
+    {
+        std::vector<WeaponPlacement> result;
+        for (int type = LightningStorm; type < SuperWeaponCount; ++type)
+        {
+            auto best = top(static_cast<SuperWeaponType>(type), k);
+            result.insert(result.end(), best.begin(), best.end());
+        }
+        std::stable_sort(result.begin(), result.end(), [](const WeaponPlacement& a, const WeaponPlacement& b)
+        {
+            return a.score > b.score;
+        });
+        if (static_cast<int>(result.size()) > k)
+            result.resize(k);
+        return result;
+    }
+};
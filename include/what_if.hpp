@@ -0,0 +1,236 @@
+/**
+ * @file what_if.hpp
+ * @author Yufei Li, Jingxuan Liu
+ * @brief Evaluating many candidate operation sets from the same game state at once.
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "simulate.hpp"
+#include "operation_set.hpp"
+
+/**
+ * @brief Result of simulating one candidate operation set.
+ */
+struct WhatIfOutcome
+{
+    GameState state;      ///< Running if the game goes on after the simulated rounds
+    int rounds;           ///< Number of rounds settled
+    int base_hp[2];
+    int coins[2];
+    double score;         ///< Score of the final state from the view of the player
+    std::size_t distinct; ///< Index of the distinct set among candidates. Candidates with equal effect share it.
+};
+
+/**
+ * @brief Batch "what-if" evaluator of candidate operation sets of a player.
+ *
+ * Each candidate is applied to the root, followed by the predicted operations of the opponent,
+ * and then simulated for some rounds with a policy for both players. Work common to all
+ * candidates is done once:
+ * - Candidates are validated against the root and reduced to distinct sets (see
+ *   operation_set.hpp), so sets differing only in order or in invalid operations are simulated
+ *   once and share their outcome;
+ * - Each worker thread keeps one Simulator and copies the root into it with Simulator::assign(),
+ *   reusing memory of towers, ants and paths instead of allocating a new state per candidate;
+ * - For player 1, the operations of player 0 are already part of the root, as in the game
+ *   process of Controller, so they are not applied again. For player 0, the predicted reply of
+ *   player 1 is applied per candidate, since a candidate EmpBlaster can invalidate it.
+ *
+ * Settlement after operations is not shared: attacks depend on towers, and moves and pheromone
+ * on the ants left by attacks, so any candidate may change every later phase.
+ *
+ * @code
+ * WhatIfEvaluator evaluator;
+ * auto sets = distinct_operation_sets(c.get_info(), c.self_player_id, candidate_operations(c.get_info(), c.self_player_id), 2);
+ * auto outcomes = evaluator.evaluate(c.get_info(), c.self_player_id, {}, sets);
+ * @endcode
+ */
+class WhatIfEvaluator
+{
+public:
+    /**
+     * @brief Decision of a player in a simulated round, as AI in template.hpp. Called from worker
+     * threads, so it must be safe to call concurrently.
+     */
+    using Policy = std::function<std::vector<Operation>(int, const GameInfo&)>;
+
+    /**
+     * @brief Score of a game state from the view of a player. Called from worker threads.
+     */
+    using Evaluation = std::function<double(const GameInfo&, int)>;
+
+    /**
+     * @brief Settings of an evaluator.
+     */
+    struct Options
+    {
+        int rounds = 1;        ///< Rounds to simulate, including the round of the candidates
+        int threads = 0;       ///< Worker threads, or 0 for one per hardware thread
+        Policy policy;         ///< Operations of both players in later rounds. None if empty.
+        Evaluation evaluation; ///< Score of final states. default_score() if empty.
+    };
+
+private:
+    Options options;
+    std::size_t distinct_count = 0;
+
+    /**
+     * @brief Simulate one distinct set from the root.
+     */
+    WhatIfOutcome simulate(Simulator& s, const Simulator& root, int player,
+        const std::vector<Operation>& opponent, const std::vector<Operation>& ops) const
+    {
+        s.assign(root);
+        for (auto& op: ops)
+            s.add_operation_of_player(player, op);
+        s.apply_operations_of_player(player);
+        if (player == 0)
+        {
+            for (auto& op: opponent)
+                s.add_operation_of_player(1, op);
+            s.apply_operations_of_player(1);
+        }
+        GameState state = s.next_round();
+        int rounds = 1;
+        for (; rounds < options.rounds && state == GameState::Running; ++rounds)
+        {
+            for (int p = 0; p < 2; ++p)
+            {
+                if (options.policy)
+                    for (auto& op: options.policy(p, s.get_info()))
+                        s.add_operation_of_player(p, op);
+                s.apply_operations_of_player(p);
+            }
+            state = s.next_round();
+        }
+        const GameInfo& info = s.get_info();
+        WhatIfOutcome outcome{state, rounds, {info.bases[0].hp, info.bases[1].hp},
+            {info.coins[0], info.coins[1]}, 0, 0};
+        if (state == GameState::Player0Win || state == GameState::Player1Win)
+            outcome.score = (state == GameState::Player0Win) == (player == 0) ? WIN_SCORE : -WIN_SCORE;
+        else
+            outcome.score = options.evaluation ? options.evaluation(info, player) : default_score(info, player);
+        return outcome;
+    }
+
+public:
+    static constexpr double WIN_SCORE = 1e9; ///< Score of a won game, and minus that of a lost one
+
+    WhatIfEvaluator() : WhatIfEvaluator(Options()) {}
+
+    explicit WhatIfEvaluator(const Options& options) : options(options) {}
+
+    /**
+     * @brief Default score: base hp difference, then coin difference.
+     */
+    static double default_score(const GameInfo& info, int player)
+    {
+        return (info.bases[player].hp - info.bases[!player].hp) * 1000.0 + info.coins[player] - info.coins[!player];
+    }
+
+    /**
+     * @brief Get the number of distinct sets simulated by the last evaluate().
+     */
+    std::size_t get_distinct_count() const
+    {
+        return distinct_count;
+    }
+
+    /**
+     * @brief Evaluate candidate operation sets of a player.
+     * @param root Current game state. If player 1 is to move, player 0 must have applied its
+     *        operations of this round, as in the game process of Controller.
+     * @param player The player to move.
+     * @param opponent Predicted operations of player 1 in this round, used if player is 0.
+     * @param candidates Candidate operation sets. Invalid operations are dropped.
+     * @return Outcomes, one per candidate and in the same order.
+     * @throw Whatever the policy or the evaluation throws.
+     */
+    std::vector<WhatIfOutcome> evaluate(const GameInfo& root, int player, const std::vector<Operation>& opponent,
+        const std::vector<std::vector<Operation>>& candidates)
+    {
+        // Reduce candidates to distinct valid sets in canonical order
+        std::vector<std::vector<Operation>> sets;
+        std::vector<std::size_t> index(candidates.size());
+        std::unordered_map<std::uint64_t, std::size_t> seen;
+        for (std::size_t i = 0; i < candidates.size(); ++i)
+        {
+            std::vector<Operation> ops;
+            for (auto& op: candidates[i])
+                if (root.is_operation_valid(player, ops, op))
+                    ops.push_back(op);
+            canonicalize(ops);
+            auto code = encode_operation_set(ops);
+            if (code)
+            {
+                auto it = seen.find(code.value());
+                if (it != seen.end())
+                {
+                    index[i] = it->second;
+                    continue;
+                }
+                seen.emplace(code.value(), sets.size());
+            }
+            index[i] = sets.size();
+            sets.push_back(std::move(ops));
+        }
+        distinct_count = sets.size();
+
+        // Simulate distinct sets in parallel
+        Simulator base(root);
+        std::vector<WhatIfOutcome> results(sets.size());
+        std::atomic<std::size_t> next(0);
+        std::exception_ptr error;
+        std::atomic<bool> failed(false);
+        auto work = [&]
+        {
+            Simulator s(base);
+            for (std::size_t i = next++; i < sets.size() && !failed; i = next++)
+            {
+                try
+                {
+                    results[i] = simulate(s, base, player, opponent, sets[i]);
+                }
+                catch (...)
+                {
+                    if (!failed.exchange(true))
+                        error = std::current_exception();
+                }
+            }
+        };
+        int threads = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+        threads = std::max(1, std::min(threads, static_cast<int>(sets.size())));
+        std::vector<std::thread> workers;
+        for (int t = 1; t < threads; ++t)
+            workers.emplace_back(work);
+        work();
+        for (auto& w: workers)
+            w.join();
+        if (error)
+            std::rethrow_exception(error);
+
+        std::vector<WhatIfOutcome> outcomes;
+        outcomes.reserve(candidates.size());
+        for (std::size_t i = 0; i < candidates.size(); ++i)
+        {
+            outcomes.push_back(results[index[i]]);
+            outcomes.back().distinct = index[i];
+        }
+        return outcomes;
+    }
+};
+
+constexpr double WhatIfEvaluator::WIN_SCORE;
@@ -0,0 +1,717 @@
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../include/simulate.hpp"
+#include "../include/io.hpp"
+
+// Local stand-in for the judger (Linux only): spawns two bots, speaks the protocol of io.hpp and
+// runs the game on Simulator. Bots receive plain text (init line, opponent operations, round
+// info) and reply with a 4-byte big-endian length header followed by their operations. A bot
+// that times out, sends a malformed message, sends an invalid operation or exits loses the game.
+// Round trips are timed from the last message a bot needs for its decision to the end of its
+// reply, so the first turn of player 0 includes process startup. With --shm, messages go through
+// the shared-memory transport of io.hpp instead, selected in bots by environment variable ANTWAR_SHM.
+//
+// With --games N, N games are played with seeds from --seed on, each with fresh bot processes.
+// With --host, each distinct bot executable is started once in host mode (environment variable
+// ANTWAR_HOST, see host_with_ai() in template.hpp) and serves all games, up to --concurrency at
+// a time, through messages multiplexed by channel, one per game and side.
+// Usage: judger [--seed N] [--time-limit MS] [--timings FILE] [--shm] [--games N] [--host]
+//               [--concurrency K] bot0 bot1
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Serialize operations as judger forwards them to the opponent.
+ */
+std::string format_operations(const std::vector<Operation>& ops)
+{
+    std::ostringstream out;
+    out << ops.size() << '\n';
+    for (auto& op: ops)
+        out << op;
+    return out.str();
+}
+
+/**
+ * @brief Serialize round info in the layout read by read_round_info().
+ */
+std::string format_round_info(const RoundInfo& info)
+{
+    std::ostringstream out;
+    out << info.round << '\n' << info.towers.size() << '\n';
+    for (const Tower& t: info.towers)
+        out << t.id << ' ' << t.player << ' ' << t.x << ' ' << t.y << ' ' << t.type << ' ' << t.cd << '\n';
+    out << info.ants.size() << '\n';
+    for (const Ant& a: info.ants)
+        out << a.id << ' ' << a.player << ' ' << a.x << ' ' << a.y << ' ' << a.hp << ' ' << a.level << ' '
+            << a.age << ' ' << a.state << '\n';
+    out << info.coin0 << ' ' << info.coin1 << '\n' << info.hp0 << ' ' << info.hp1 << '\n';
+    return out.str();
+}
+
+/**
+ * @brief Parse a reply of a bot.
+ * @return Whether the reply is well formed, i.e. complete and nothing but operations.
+ */
+bool parse_operations(const std::string& message, std::vector<Operation>& ops)
+{
+    std::istringstream in(message);
+    ops = read_opponent_operations(in);
+    std::string rest;
+    return !in.fail() && !(in >> rest);
+}
+
+/**
+ * @brief A message from judger to a bot.
+ */
+struct Message
+{
+    enum Kind
+    {
+        Init,
+        Operations,
+        Round
+    };
+
+    Kind kind;
+    InitInfo init;                     ///< For Init
+    const std::vector<Operation>* ops; ///< For Operations
+    const RoundInfo* round;            ///< For Round
+
+    /**
+     * @brief Get the message in the text protocol.
+     */
+    std::string text() const
+    {
+        if (kind == Init)
+            return std::to_string(init.first) + ' ' + std::to_string(init.second) + '\n';
+        return kind == Operations ? format_operations(*ops) : format_round_info(*round);
+    }
+};
+
+/**
+ * @brief A child process with pipes to its stdin and stdout.
+ */
+class Process
+{
+private:
+    pid_t pid = -1;
+    int to_child = -1;   ///< Write end of the stdin of the child
+    int from_child = -1; ///< Read end of the stdout of the child
+
+public:
+    Process() = default;
+    Process(const Process&) = delete;
+    Process& operator=(const Process&) = delete;
+
+    ~Process()
+    {
+        stop();
+    }
+
+    /**
+     * @brief Start an executable.
+     * @param path Path of the executable.
+     * @param env Environment variable to set in the child as "NAME=value", or empty.
+     * @return Whether the process has been started.
+     */
+    bool start(const char* path, const std::string& env)
+    {
+        // Close-on-exec, so that other bots do not inherit the ends of these pipes. Duplicating them
+        // onto stdin and stdout clears the flag for the child.
+        int in[2], out[2];
+        if (pipe2(in, O_CLOEXEC) != 0)
+            return false;
+        if (pipe2(out, O_CLOEXEC) != 0)
+        {
+            close(in[0]);
+            close(in[1]);
+            return false;
+        }
+        pid = fork();
+        if (pid < 0)
+        {
+            close(in[0]);
+            close(in[1]);
+            close(out[0]);
+            close(out[1]);
+            return false;
+        }
+        if (pid == 0)
+        {
+            dup2(in[0], STDIN_FILENO);
+            dup2(out[1], STDOUT_FILENO);
+            close(in[0]);
+            close(in[1]);
+            close(out[0]);
+            close(out[1]);
+            if (!env.empty())
+                putenv(const_cast<char*>(env.c_str()));
+            execl(path, path, static_cast<char*>(nullptr));
+            std::perror(path);
+            _exit(127);
+        }
+        close(in[0]);
+        close(out[1]);
+        to_child = in[1];
+        from_child = out[0];
+        return true;
+    }
+
+    /**
+     * @brief Get the file descriptor to poll for output of the child.
+     */
+    int output() const
+    {
+        return from_child;
+    }
+
+    /**
+     * @brief Write to the stdin of the child.
+     * @return Whether all of it has been written.
+     */
+    bool write_all(const std::string& data)
+    {
+        const char* p = data.data();
+        std::size_t left = data.size();
+        while (left > 0)
+        {
+            ssize_t n = write(to_child, p, left);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            p += n;
+            left -= n;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Read exactly "size" bytes from the stdout of the child before a deadline.
+     */
+    bool read_exactly(char* buf, std::size_t size, Clock::time_point deadline)
+    {
+        while (size > 0)
+        {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            pollfd fd{from_child, POLLIN, 0};
+            int ready = poll(&fd, 1, static_cast<int>(std::max<long long>(left, 0)));
+            if (ready < 0 && errno == EINTR)
+                continue;
+            if (ready <= 0)
+                return false;
+            ssize_t n = read(from_child, buf, size);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            buf += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Read a 4-byte big-endian integer before a deadline.
+     */
+    bool read_u32(std::uint32_t& value, Clock::time_point deadline)
+    {
+        unsigned char buf[4];
+        if (!read_exactly(reinterpret_cast<char*>(buf), 4, deadline))
+            return false;
+        value = std::uint32_t(buf[0]) << 24 | buf[1] << 16 | buf[2] << 8 | buf[3];
+        return true;
+    }
+
+    /**
+     * @brief Read a message framed by a 4-byte big-endian length header before a deadline.
+     */
+    bool read_framed(std::string& message, Clock::time_point deadline)
+    {
+        std::uint32_t size;
+        if (!read_u32(size, deadline) || size > (1 << 20))
+            return false;
+        message.resize(size);
+        return read_exactly(&message[0], size, deadline);
+    }
+
+    /**
+     * @brief Kill the child and wait for it, if still running.
+     */
+    void stop()
+    {
+        if (to_child != -1)
+            close(to_child);
+        if (from_child != -1)
+            close(from_child);
+        to_child = from_child = -1;
+        if (pid > 0)
+        {
+            kill(pid, SIGKILL);
+            waitpid(pid, nullptr, 0);
+            pid = -1;
+        }
+    }
+};
+
+/**
+ * @brief Encode a 4-byte big-endian integer.
+ */
+std::string encode_u32(std::uint32_t value)
+{
+    char buf[4];
+    convert_to_big_endian(&value, sizeof(value), buf);
+    return std::string(buf, 4);
+}
+
+/**
+ * @brief A bot process playing one game, talking through pipes or through a shared-memory region.
+ */
+class Bot
+{
+private:
+    Process process;
+    std::unique_ptr<ShmTransport> shm; ///< Shared-memory transport, if used instead of the pipes
+
+public:
+    /**
+     * @brief Start a bot executable.
+     * @param path Path of the executable.
+     * @param shm_path Path of a shared-memory region to talk through, or empty to use pipes.
+     * @return Whether the process has been started.
+     */
+    bool start(const char* path, const std::string& shm_path)
+    {
+        if (!shm_path.empty() && !(shm = ShmTransport::create(shm_path)))
+            return false;
+        return process.start(path, shm ? "ANTWAR_SHM=" + shm_path : "");
+    }
+
+    void send(const Message& message)
+    {
+        if (!shm)
+            process.write_all(message.text());
+        else if (message.kind == Message::Init)
+            shm->send_init_info(message.init);
+        else if (message.kind == Message::Operations)
+            shm->send_operations(*message.ops);
+        else
+            shm->send_round_info(*message.round);
+    }
+
+    /**
+     * @brief Receive the operations of the bot.
+     * @param ops Result.
+     * @param deadline Time by which the whole reply must be received.
+     * @return Null on success, or why the bot loses.
+     */
+    const char* receive_operations(std::vector<Operation>& ops, Clock::time_point deadline)
+    {
+        if (shm)
+            return shm->read_operations(ops, deadline) ? nullptr : "no reply in time or malformed reply";
+        std::string message;
+        if (!process.read_framed(message, deadline))
+            return "no reply in time or bot exited";
+        return parse_operations(message, ops) ? nullptr : "malformed reply";
+    }
+
+    void stop()
+    {
+        process.stop();
+        shm.reset();
+    }
+};
+
+/**
+ * @brief Round trip time of a turn.
+ */
+struct Turn
+{
+    int game;
+    int round;
+    int player;
+    long long us;
+};
+
+/**
+ * @brief One game on the judger side, driven by the replies of players, however they are reached.
+ */
+class Game
+{
+public:
+    /**
+     * @brief Deliver a message to a player.
+     */
+    using Send = std::function<void(int player, const Message&)>;
+
+private:
+    int index;
+    Send send;
+    Simulator s;
+    std::vector<Operation> ops[2];
+    RoundInfo round_info;
+    Clock::time_point asked[2]; ///< When each player got the last message it needs to decide
+    int waiting = 0;            ///< Player whose reply is awaited, or -1 if the game is over
+
+    void ask(int player, const Message& message)
+    {
+        send(player, message);
+        asked[player] = Clock::now();
+    }
+
+public:
+    GameState state = GameState::Running;
+    int loser = -1;         ///< Player who lost by breaking the rules, or -1
+    const char* reason = "";
+
+    /**
+     * @brief Start a game by sending init info to both players.
+     */
+    Game(int index, unsigned long long seed, Send send) : index(index), send(std::move(send)), s(GameInfo{seed})
+    {
+        for (int player = 0; player < 2; ++player)
+            ask(player, {Message::Init, {player, seed}, nullptr, nullptr});
+    }
+
+    /**
+     * @brief Get the player whose reply is awaited, or -1 if the game is over.
+     */
+    int get_waiting() const
+    {
+        return waiting;
+    }
+
+    /**
+     * @brief Get the time by which the awaited reply must be received.
+     */
+    Clock::time_point deadline(long long time_limit) const
+    {
+        return asked[waiting] + std::chrono::milliseconds(time_limit);
+    }
+
+    const GameInfo& get_info()
+    {
+        return s.get_info();
+    }
+
+    /**
+     * @brief Make the awaited player lose.
+     */
+    void fail(const char* why)
+    {
+        loser = waiting;
+        reason = why;
+        state = loser == 0 ? GameState::Player1Win : GameState::Player0Win;
+        waiting = -1;
+    }
+
+    /**
+     * @brief Take the reply of the awaited player and go on until another reply is needed.
+     * @param reply Operations of the player.
+     * @param turns Timings, to which the round trip of the reply is added.
+     */
+    void reply(std::vector<Operation> reply, std::vector<Turn>& turns)
+    {
+        int player = waiting;
+        turns.push_back({index, s.get_info().round, player,
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - asked[player]).count()});
+        ops[player] = std::move(reply);
+        for (auto& op: ops[player])
+            if (!s.add_operation_of_player(player, op))
+                return fail("invalid operation");
+        s.apply_operations_of_player(player);
+        // Player 1 sees the operations of player 0 before deciding
+        if (player == 0)
+        {
+            ask(1, {Message::Operations, {}, &ops[0], nullptr});
+            waiting = 1;
+            return;
+        }
+        send(0, {Message::Operations, {}, &ops[1], nullptr});
+        state = s.next_round(&round_info.ants);
+        if (state != GameState::Running)
+        {
+            waiting = -1;
+            return;
+        }
+        const GameInfo& info = s.get_info();
+        round_info.round = info.round;
+        round_info.towers = info.towers;
+        round_info.coin0 = info.coins[0];
+        round_info.coin1 = info.coins[1];
+        round_info.hp0 = info.bases[0].hp;
+        round_info.hp1 = info.bases[1].hp;
+        for (int p = 0; p < 2; ++p)
+            ask(p, {Message::Round, {}, nullptr, &round_info});
+        waiting = 0;
+    }
+};
+
+/**
+ * @brief Settings from the command line.
+ */
+struct Options
+{
+    unsigned long long seed = 1;
+    long long time_limit = 1000; ///< Per turn, in milliseconds
+    const char* timings_path = nullptr;
+    bool shm = false;
+    int games = 1;
+    bool host = false;
+    int concurrency = 1;
+    std::vector<const char*> paths;
+};
+
+/**
+ * @brief Play games one by one, each with fresh bot processes.
+ */
+void play_with_processes(const Options& options, std::vector<std::unique_ptr<Game>>& games, std::vector<Turn>& turns)
+{
+    for (int i = 0; i < options.games; ++i)
+    {
+        Bot bots[2];
+        for (int player = 0; player < 2; ++player)
+        {
+            std::string shm_path;
+            if (options.shm)
+                shm_path = "/dev/shm/antwar-judger-" + std::to_string(getpid()) + "-" + std::to_string(player);
+            if (!bots[player].start(options.paths[player], shm_path))
+            {
+                std::perror("judger");
+                std::exit(1);
+            }
+        }
+        games.emplace_back(new Game(i, options.seed + i, [&bots](int player, const Message& message)
+        {
+            bots[player].send(message);
+        }));
+        Game& game = *games.back();
+        std::vector<Operation> ops;
+        while (game.get_waiting() != -1)
+        {
+            const char* reason = bots[game.get_waiting()].receive_operations(ops, game.deadline(options.time_limit));
+            if (reason)
+                game.fail(reason);
+            else
+                game.reply(std::move(ops), turns);
+        }
+    }
+}
+
+/**
+ * @brief Play games on bot hosts started once, with up to "concurrency" games at a time.
+ *
+ * Each message to a host is the 4-byte big-endian channel (2 * game + player), a 4-byte
+ * big-endian length and the text message, and an empty message ends the game of its channel.
+ * Each reply is the channel followed by the usual reply of a bot.
+ */
+void play_with_hosts(const Options& options, std::vector<std::unique_ptr<Game>>& games, std::vector<Turn>& turns)
+{
+    // One host per distinct executable, possibly serving both sides
+    std::unique_ptr<Process> hosts[2];
+    Process* host_of[2];
+    for (int player = 0; player < 2; ++player)
+    {
+        if (player == 1 && !std::strcmp(options.paths[0], options.paths[1]))
+        {
+            host_of[1] = host_of[0];
+            break;
+        }
+        hosts[player].reset(new Process);
+        if (!hosts[player]->start(options.paths[player], "ANTWAR_HOST=1"))
+        {
+            std::perror("judger");
+            std::exit(1);
+        }
+        host_of[player] = hosts[player].get();
+    }
+
+    std::vector<int> active;
+    int started = 0;
+    auto end = [&](int game)
+    {
+        for (int player = 0; player < 2; ++player)
+            host_of[player]->write_all(encode_u32(2 * game + player) + encode_u32(0));
+        active.erase(std::find(active.begin(), active.end(), game));
+    };
+    auto start_games = [&]
+    {
+        while (started < options.games && static_cast<int>(active.size()) < options.concurrency)
+        {
+            int index = started++;
+            games.emplace_back(new Game(index, options.seed + index, [&, index](int player, const Message& message)
+            {
+                std::string text = message.text();
+                host_of[player]->write_all(encode_u32(2 * index + player) + encode_u32(text.size()) + text);
+            }));
+            active.push_back(index);
+        }
+    };
+    start_games();
+    std::string message;
+    std::vector<Operation> ops;
+    while (!active.empty())
+    {
+        // Wait for any host until the earliest deadline
+        Clock::time_point deadline = Clock::time_point::max();
+        for (int game: active)
+            deadline = std::min(deadline, games[game]->deadline(options.time_limit));
+        std::vector<pollfd> fds;
+        for (auto& host: hosts)
+            if (host)
+                fds.push_back({host->output(), POLLIN, 0});
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        if (poll(fds.data(), fds.size(), static_cast<int>(std::max<long long>(left, 0))) < 0 && errno != EINTR)
+            break;
+        for (auto& fd: fds)
+        {
+            if (!(fd.revents & (POLLIN | POLLHUP)))
+                continue;
+            Process& host = hosts[0] && hosts[0]->output() == fd.fd ? *hosts[0] : *hosts[1];
+            std::uint32_t channel;
+            Clock::time_point read_deadline = Clock::now() + std::chrono::milliseconds(options.time_limit);
+            if (!host.read_u32(channel, read_deadline) || !host.read_framed(message, read_deadline))
+            {
+                // A host that exits or sends garbage loses every game it is waited for
+                for (int game: std::vector<int>(active))
+                    if (host_of[games[game]->get_waiting()] == &host)
+                    {
+                        games[game]->fail("host exited or sent a malformed reply");
+                        end(game);
+                    }
+                continue;
+            }
+            int game = channel / 2, player = channel % 2;
+            // Replies of games ended by a timeout are dropped
+            if (std::find(active.begin(), active.end(), game) == active.end() || games[game]->get_waiting() != player)
+                continue;
+            if (parse_operations(message, ops))
+                games[game]->reply(std::move(ops), turns);
+            else
+                games[game]->fail("malformed reply");
+            if (games[game]->get_waiting() == -1)
+                end(game);
+        }
+        Clock::time_point now = Clock::now();
+        for (int game: std::vector<int>(active))
+            if (games[game]->deadline(options.time_limit) < now)
+            {
+                games[game]->fail("no reply in time");
+                end(game);
+            }
+        start_games();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!std::strcmp(argv[i], "--seed") && i + 1 < argc)
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--time-limit") && i + 1 < argc)
+            options.time_limit = std::atoll(argv[++i]);
+        else if (!std::strcmp(argv[i], "--timings") && i + 1 < argc)
+            options.timings_path = argv[++i];
+        else if (!std::strcmp(argv[i], "--shm"))
+            options.shm = true;
+        else if (!std::strcmp(argv[i], "--games") && i + 1 < argc)
+            options.games = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--host"))
+            options.host = true;
+        else if (!std::strcmp(argv[i], "--concurrency") && i + 1 < argc)
+            options.concurrency = std::max(1, std::atoi(argv[++i]));
+        else
+            options.paths.push_back(argv[i]);
+    }
+    if (options.paths.size() != 2 || (options.host && options.shm))
+    {
+        std::fprintf(stderr, "Usage: %s [--seed N] [--time-limit MS] [--timings FILE] [--shm] [--games N] [--host] "
+            "[--concurrency K] bot0 bot1\n(--shm and --host cannot be combined)\n", argv[0]);
+        return 2;
+    }
+    signal(SIGPIPE, SIG_IGN); // A bot that exits early shows up as a failed write
+
+    std::vector<std::unique_ptr<Game>> games;
+    std::vector<Turn> turns;
+    auto start = Clock::now();
+    if (options.host)
+        play_with_hosts(options, games, turns);
+    else
+        play_with_processes(options, games, turns);
+    double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    const char* names[] = {"player 0 wins", "player 1 wins", "running", "draw"};
+    int results[4] = {}, errors = 0;
+    for (auto& game: games)
+    {
+        ++results[static_cast<int>(game->state)];
+        errors += game->loser != -1;
+    }
+    if (options.games == 1)
+    {
+        Game& game = *games[0];
+        const GameInfo& info = game.get_info();
+        std::printf("result: %s", names[static_cast<int>(game.state)]);
+        if (game.loser != -1)
+            std::printf(" (player %d: %s)", game.loser, game.reason);
+        std::printf("\nrounds: %d, base hp: %d %d\n", info.round, info.bases[0].hp, info.bases[1].hp);
+    }
+    else
+    {
+        std::printf("games: %zu, player 0 wins %d, player 1 wins %d, draws %d, lost by breaking rules %d\n",
+            games.size(), results[GameState::Player0Win], results[GameState::Player1Win], results[GameState::Undecided], errors);
+        std::printf("time: %.1f ms, %.2f ms/game\n", elapsed, elapsed / games.size());
+    }
+    for (int player = 0; player < 2; ++player)
+    {
+        std::vector<long long> us;
+        long long first = 0;
+        for (std::size_t i = 0; i < turns.size(); ++i)
+            if (turns[i].player == player)
+            {
+                if (i == 0 || turns[i].round == 0)
+                    first += turns[i].us;
+                us.push_back(turns[i].us);
+            }
+        if (us.empty())
+            continue;
+        std::sort(us.begin(), us.end());
+        long long sum = 0;
+        for (long long t: us)
+            sum += t;
+        std::printf("player %d round trip: %zu turns, first %lld us, mean %lld us, p50 %lld us, p99 %lld us, max %lld us\n",
+            player, us.size(), first / static_cast<long long>(games.size()), sum / static_cast<long long>(us.size()),
+            us[us.size() / 2], us[std::min(us.size() - 1, us.size() * 99 / 100)], us.back());
+    }
+    if (options.timings_path)
+    {
+        if (FILE* f = std::fopen(options.timings_path, "w"))
+        {
+            std::fprintf(f, "game,round,player,us\n");
+            for (auto& t: turns)
+                std::fprintf(f, "%d,%d,%d,%lld\n", t.game, t.round, t.player, t.us);
+            std::fclose(f);
+        }
+        else
+            std::perror(options.timings_path);
+    }
+    return 0;
+}